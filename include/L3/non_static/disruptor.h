@@ -1,5 +1,5 @@
-#ifndef DISRUPTOR_H
-#define DISRUPTOR_H
+#ifndef NON_STATIC_DISRUPTOR_H
+#define NON_STATIC_DISRUPTOR_H
 /*
 The MIT License (MIT)
 
@@ -25,186 +25,599 @@ SOFTWARE.
 */
 
 #include <L3/util/cacheline.h>
-#include <L3/util/ring.h>
+#include <L3/util/memory.h>
 #include <L3/util/types.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 namespace L3 // Low Latency Library
 {
-    using Cursor = std::atomic<Index>;
-
-    template<size_t size>
-    class Barrier
+    //
+    // Disruptors created at runtime. The static disruptor is keyed on
+    // types and its ring and cursors are at addresses fixed at link
+    // time. Here the size of the ring is chosen at construction and
+    // the ring and cursors live in a single block of memory laid out
+    // as
+    //
+    //     header | commit cursor | claim cursor | consumer cursors | ring
+    //
+    // with each cursor on its own cache line. Producers and consumers
+    // are objects holding pointers into the block. They keep copies
+    // of what they need so the fast path doesn't go back through the
+    // disruptor.
+    //
+    // Since nothing in the block is a pointer it can be shared
+    // between processes. One creates the disruptor in named shared
+    // memory and others attach to it. Put and Get work across
+    // processes just as they do across threads.
+    //
+    namespace NonStatic
     {
-        const Cursor* const _cursors[size];
+        using Cursor = std::atomic<Index>;
+
+        //
+        // Describes the layout so that another process can attach to
+        // a disruptor in shared memory and check it's what it
+        // expects. The creator sets magic last.
+        //
+        struct Header
+        {
+            static constexpr uint64_t Magic = 0x4c33446973727570; // L3Disrup
+            static constexpr uint32_t Version = 1;
 
-        Index least() const
+            std::atomic<uint64_t> magic;
+            uint32_t version;
+            uint32_t msgSize;
+            Index size;
+            Index maxConsumers;
+            Counter consumers;
+        };
+
+        template<typename Slot>
+        class Iterator: public std::iterator<std::random_access_iterator_tag, Slot>
         {
-            Index result = cursors[0];
-            for(auto c: cursors)
+        public:
+            Iterator(Slot* ring, Index mask, Index index):
+                _ring(ring),
+                _mask(mask),
+                _index(index)
+            {}
+
+            Slot& operator*() const { return _ring[_index & _mask]; }
+            Slot* operator->() const { return &_ring[_index & _mask]; }
+
+            Iterator& operator++()
             {
-                Index i = c.load(std::memory_order_acquire);
-                if(i < result)
-                {
-                    result = i;
-                }
+                ++_index;
+                return *this;
             }
-            return result;
-        }
-    };
 
-    template<size_t size, typename SpinPolicy=NoOp>
-    class Consumer
-    {
-        L3_CACHE_LINE Cursor _cursor;
-        const Barrier<size> _barrier;
+            Iterator operator++(int)
+            {
+                Iterator result{*this};
+                ++_index;
+                return result;
+            }
 
-        Index cursor() const
+            std::ptrdiff_t operator-(const Iterator& rhs) const
+            {
+                return _index - rhs._index;
+            }
+
+            bool operator==(const Iterator& rhs) const
+            {
+                return _index == rhs._index;
+            }
+            bool operator!=(const Iterator& rhs) const
+            {
+                return _index != rhs._index;
+            }
+
+            operator Index() const { return _index; }
+
+        private:
+            Slot* _ring;
+            Index _mask;
+            Index _index;
+        };
+
+        template<typename T>
+        class Disruptor
         {
+        public:
+            using Msg = T;
+            using Slot = CacheLine<Msg>;
             //
-            // When we read our cursor we know that only us - this
-            // thread - can have modified the value therefore relaxed
-            // memrory order is sufficient.
+            // Private to this process, or to processes forked after
+            // it with Memory::shared. Given a node the ring is placed
+            // on that NUMA node, which should be the one its
+            // consumers run on.
             //
-            return cursor.load(std::memory_order_relaxed);
-        }
-        
-        Index claim(Index begin)
-        {
+            Disruptor(size_t log2size,
+                      size_t maxConsumers,
+                      Memory::Backing backing = Memory::heap,
+                      unsigned options = Memory::none,
+                      int node = Numa::anyNode):
+                _memory(bytes(Index(1) << log2size, maxConsumers),
+                        backing,
+                        options,
+                        node),
+                _owner(true)
+            {
+                initialise(log2size, maxConsumers);
+            }
             //
-            // The cursor is the start of a dependency chain
-            // leading to reading a message from the ring
-            // buffer. Therefore consume semantics are sufficient to
-            // ensure synchronisation.
+            // In named shared memory for other processes to attach
+            // to. Messages are copied between processes so must be
+            // trivially copyable.
             //
-            Index end;
-            SpinPolicy sp;
-            while((end = _barrier.least()) <= begin)
+            enum Create { create };
+            Disruptor(Create,
+                      const std::string& name,
+                      size_t log2size,
+                      size_t maxConsumers,
+                      unsigned options = Memory::none,
+                      int node = Numa::anyNode):
+                _memory(Memory::create(
+                            name,
+                            bytes(Index(1) << log2size, maxConsumers),
+                            options,
+                            node)),
+                _owner(true)
             {
-                sp();
+                static_assert(std::is_trivially_copyable<Msg>::value,
+                              "Shared messages must be trivially copyable");
+                initialise(log2size, maxConsumers);
+            }
+            //
+            // Create in place of a stale one with the same name. See
+            // Memory::replace.
+            //
+            enum Replace { replace };
+            Disruptor(Replace,
+                      const std::string& name,
+                      size_t log2size,
+                      size_t maxConsumers,
+                      unsigned options = Memory::none,
+                      int node = Numa::anyNode):
+                _memory(Memory::replace(
+                            name,
+                            bytes(Index(1) << log2size, maxConsumers),
+                            options,
+                            node)),
+                _owner(true)
+            {
+                static_assert(std::is_trivially_copyable<Msg>::value,
+                              "Shared messages must be trivially copyable");
+                initialise(log2size, maxConsumers);
+            }
+            //
+            // Attach to a disruptor another process has created. Throws
+            // if it's not there yet or isn't laid out as we expect.
+            //
+            enum Attach { attach };
+            Disruptor(Attach,
+                      const std::string& name,
+                      unsigned options = Memory::none):
+                _memory(Memory::attach(name, options)),
+                _owner(false)
+            {
+                static_assert(std::is_trivially_copyable<Msg>::value,
+                              "Shared messages must be trivially copyable");
+                check();
+                map();
             }
-            return end;
-        }
 
-        void cursor(Index end)
-        {
+            Disruptor(const Disruptor&) = delete;
+            Disruptor& operator=(const Disruptor&) = delete;
+
+            ~Disruptor()
+            {
+                if(!_owner)
+                {
+                    return;
+                }
+                for(size_t i = 0; i < size(); ++i)
+                {
+                    _ring[i].~Slot();
+                }
+            }
+
+            size_t size() const { return _header->size; }
+            Index mask() const { return _mask; }
+            const Memory& memory() const { return _memory; }
+            Slot* ring() const { return _ring; }
             //
-            // When writing to our cursor we have to ensure that the
-            // new value is released to other threads to aquire.
+            // End of the committed messages. Consumers of the
+            // producer gate on this.
             //
-            cursor.store(end, std::memory_order_release);
-        }
+            Cursor& cursor() const { return _cursors[0]; }
+            Cursor& claimCursor() const { return _cursors[1]; }
+            //
+            // Give a new consumer its cursor.
+            //
+            Cursor& addConsumer()
+            {
+                Index i = _header->consumers.load();
+                do
+                {
+                    if(i >= _header->maxConsumers)
+                    {
+                        throw std::length_error("Too many consumers");
+                    }
+                }
+                while(!_header->consumers.compare_exchange_weak(i, i + 1));
+                return _cursors[2 + i];
+            }
+            //
+            // Consumer cursors by number. Processes sharing a
+            // disruptor agree which consumer is which and use this
+            // rather than addConsumer.
+            //
+            Cursor& consumerCursor(size_t i) const
+            {
+                if(i >= _header->maxConsumers)
+                {
+                    throw std::out_of_range("No such consumer");
+                }
+                return _cursors[2 + i];
+            }
 
-    public:
-        friend class Get;
-        
-        //
-        // RAII semantics to perform a get. Ensures that we always
-        // commit.
-        //
-        class Get
-        {
-            Get(const Consumer& consumer):
+            static size_t bytes(size_t size, size_t maxConsumers)
+            {
+                return cache_line_size +
+                    (2 + maxConsumers) * sizeof(CacheLine<Cursor>) +
+                    size * sizeof(Slot);
+            }
+
+        private:
+            size_t cursors() const { return 2 + _header->maxConsumers; }
+
+            void initialise(size_t log2size, size_t maxConsumers)
+            {
+                static_assert(sizeof(Header) <= cache_line_size,
+                              "Header must fit in a cache line");
+                _header = new(_memory.data()) Header();
+                _header->version = Header::Version;
+                _header->msgSize = sizeof(Msg);
+                _header->size = Index(1) << log2size;
+                _header->maxConsumers = maxConsumers;
+                _header->consumers.store(0, std::memory_order_relaxed);
+                map();
                 //
-                // Only a single thread should be modifying the read cursor.
+                // Cursors start as if they've already been round the
+                // ring once. See static/put.h.
                 //
-                _begin{consumer.cursor.load(std::memory_order_relaxed)},
-                _end{claim(_begin)}
-            {}
-        
-            Get(size_t maxBatchSize):
-                _begin{cursor.load(std::memory_order_relaxed)},
-                _end{std::min(claim(_begin), _begin + maxBatchSize)}
+                for(size_t i = 0; i < cursors(); ++i)
+                {
+                    new(&_cursors[i]) CacheLine<Cursor>();
+                    _cursors[i].store(size(), std::memory_order_relaxed);
+                }
+                //
+                // New memory is zeroed, which is all value
+                // initialising a trivial Slot would do. Skipping it
+                // leaves mapped pages untouched until first used, or
+                // prefaulted.
+                //
+                if(!std::is_trivially_default_constructible<Slot>::value)
+                {
+                    for(size_t i = 0; i < size(); ++i)
+                    {
+                        new(&_ring[i]) Slot();
+                    }
+                }
+                _header->magic.store(Header::Magic, std::memory_order_release);
+            }
+
+            void check()
             {
+                auto header = static_cast<Header*>(_memory.data());
+                if(_memory.size() < sizeof(Header) ||
+                   header->magic.load(std::memory_order_acquire) !=
+                   Header::Magic)
+                {
+                    throw std::runtime_error(
+                        _memory.name() + ": not a disruptor or not ready");
+                }
+                if(header->version != Header::Version ||
+                   header->msgSize != sizeof(Msg) ||
+                   _memory.size() <
+                   bytes(header->size, header->maxConsumers))
+                {
+                    throw std::runtime_error(
+                        _memory.name() + ": layout mismatch");
+                }
             }
 
-            enum NoBlock { noBlock };
-            Get(size_t maxBatchSize, NoBlock):
-                _begin(cursor.load(std::memory_order_relaxed)),
-                _end(std::min(Barrier::least(), _begin + maxBatchSize))
+            void map()
             {
+                char* base = static_cast<char*>(_memory.data());
+                _header = reinterpret_cast<Header*>(base);
+                _cursors = reinterpret_cast<CacheLine<Cursor>*>(
+                    base + cache_line_size);
+                _ring = reinterpret_cast<Slot*>(_cursors + cursors());
+                _mask = _header->size - 1;
             }
 
-            Get(NoBlock):
-                _begin(cursor.load(std::memory_order_relaxed)),
-                _end(Barrier::least())
+            Memory _memory;
+            const bool _owner;
+            Header* _header;
+            CacheLine<Cursor>* _cursors;
+            Slot* _ring;
+            Index _mask;
+        };
+        //
+        // The least of a set of cursors. Anything with a cursor() can
+        // be a member, so a disruptor for its producer or a consumer,
+        // as can a cursor itself.
+        //
+        class Barrier
+        {
+        public:
+            template<typename T,
+                     typename... Ts,
+                     typename = typename std::enable_if<
+                         !std::is_same<T, Barrier>::value>::type>
+            explicit Barrier(T& t, Ts&... ts):
+                _cursors{cursorOf(t), cursorOf(ts)...}
             {}
-        
-            ~Get()
+
+            Index least() const
             {
-                if(_begin != _end)
+                Index result = std::numeric_limits<Index>::max();
+                for(auto c: _cursors)
                 {
-                    cursor.store(_end, std::memory_order_release);
+                    result = std::min(
+                        result, c->load(std::memory_order_acquire));
                 }
+                return result;
             }
 
-            using Iterator = T*;
-            Iterator begin() const { return _begin; }
-            Iterator end() const { return _end; }
+        private:
+            std::vector<const Cursor*> _cursors;
+
+            template<typename T>
+            static const Cursor* cursorOf(T& t) { return &t.cursor(); }
+            static const Cursor* cursorOf(Cursor& c) { return &c; }
+        };
 
-            L3_CACHE_LINE static L3::Sequence cursor;
+        template<typename Msg, typename SpinPolicy=NoOp>
+        class Consumer
+        {
+        public:
+            using Slot = typename Disruptor<Msg>::Slot;
+
+            Consumer(Disruptor<Msg>& d, Barrier barrier):
+                Consumer(d, std::move(barrier), d.addConsumer())
+            {}
+            //
+            // Use consumer cursor i. See Disruptor::consumerCursor.
+            //
+            Consumer(Disruptor<Msg>& d, Barrier barrier, size_t i):
+                Consumer(d, std::move(barrier), d.consumerCursor(i))
+            {}
+
+            Cursor& cursor() const { return _cursor; }
+            //
+            // As for the static Get. All the messages available, at
+            // most maxBatchSize of them or don't block.
+            //
+            class Get
+            {
+            public:
+                using Iterator = NonStatic::Iterator<Slot>;
+
+                Get(Consumer& c):
+                    _consumer(c),
+                    _begin(c._cursor.load(std::memory_order_relaxed)),
+                    _end(c.claim(_begin))
+                {}
+
+                Get(Consumer& c, size_t maxBatchSize):
+                    _consumer(c),
+                    _begin(c._cursor.load(std::memory_order_relaxed)),
+                    _end(std::min(c.claim(_begin), _begin + maxBatchSize))
+                {}
+
+                enum NoBlock { noBlock };
+                Get(Consumer& c, NoBlock):
+                    _consumer(c),
+                    _begin(c._cursor.load(std::memory_order_relaxed)),
+                    _end(c.available(_begin))
+                {}
+
+                Get(const Get&) = delete;
+                Get& operator=(const Get&) = delete;
+
+                ~Get()
+                {
+                    if(_begin != _end)
+                    {
+                        _consumer._cursor.store(
+                            _end, std::memory_order_release);
+                    }
+                }
+
+                Iterator begin() const
+                {
+                    return Iterator(_consumer._ring, _consumer._mask, _begin);
+                }
+                Iterator end() const
+                {
+                    return Iterator(_consumer._ring, _consumer._mask, _end);
+                }
+
+            private:
+                Consumer& _consumer;
+                const Index _begin;
+                const Index _end;
+            };
 
         private:
-            Iterator _begin;
-            Iterator _end;
+            Cursor& _cursor;
+            Slot* const _ring;
+            const Index _mask;
+            const Barrier _barrier;
 
-            Get(Index b, Index e):
-                _begin(b),
-                _end(e)
+            Consumer(Disruptor<Msg>& d, Barrier barrier, Cursor& cursor):
+                _cursor(cursor),
+                _ring(d.ring()),
+                _mask(d.mask()),
+                _barrier(std::move(barrier)),
+                _available(0)
             {}
-        
-            static Index claim(Index begin)
+            //
+            // Last value seen of the barrier. See static/barrier.h.
+            //
+            Index _available;
+
+            Index available(Index begin)
             {
-                //
-                // The cursor is the start of a dependency chain
-                // leading to reading a message from the ring
-                // buffer. Therefore consume semantics are sufficient to
-                // ensure synchronisation.
-                //
-                Index end;
+                if(_available <= begin)
+                {
+                    _available = _barrier.least();
+                }
+                return _available;
+            }
+
+            Index claim(Index begin)
+            {
+                if(_available > begin)
+                {
+                    return _available;
+                }
                 SpinPolicy sp;
-                while((end = Barrier::least()) <= begin)
+                while((_available = _barrier.least()) <= begin)
                 {
                     sp();
                 }
-                return end;
+                return _available;
             }
         };
-    };
 
-    //
-    // Disruptor containing buffer of size Msg objects. Getters is the
-    // number of consumers.
-    //
-    template<typename Msg, size_t size, size_t getters>
-    class Disruptor
-    {
-    public:
-        using Ring = L3::Ring<CacheLine<Msg>, size>;
-        using Iterator = typename Ring::template Iterator<ring>;
-        
-        Ring<CacheLine<Msg>, size> _ring;
+        namespace CommitPolicy
+        {
+            struct Unique
+            {
+                template<typename SpinPolicy>
+                static void commit(Cursor& cursor, Index slot)
+                {
+                    cursor.store(slot + 1, std::memory_order_release);
+                }
+            };
+
+            struct Shared
+            {
+                //
+                // Wait for producers that claimed earlier slots to
+                // commit. See static/put.h.
+                //
+                template<typename SpinPolicy>
+                static void commit(Cursor& cursor, Index slot)
+                {
+                    SpinPolicy sp;
+                    while(cursor.load(std::memory_order_acquire) < slot)
+                    {
+                        sp();
+                    }
+                    cursor.store(slot + 1, std::memory_order_release);
+                }
+            };
+        }
         //
-        // Allow one extra space for the write cursor.
+        // One per producer thread. With CommitPolicy::Shared several
+        // producers share a disruptor, each with its own Producer.
         //
-        Barrier<getters + 1> getters;
+        template<typename Msg,
+                 typename CommitPolicy=CommitPolicy::Unique,
+                 typename SpinPolicy=NoOp>
+        class Producer
+        {
+        public:
+            using Slot = typename Disruptor<Msg>::Slot;
+
+            Producer(Disruptor<Msg>& d, Barrier gating):
+                _claimCursor(d.claimCursor()),
+                _cursor(d.cursor()),
+                _ring(d.ring()),
+                _mask(d.mask()),
+                _size(d.size()),
+                _gating(std::move(gating)),
+                _least(0)
+            {}
 
-        Cursor cursor;
-    };
+            class Put
+            {
+            public:
+                Put(Producer& p): _producer(p), _slot(p.claim()) {}
 
-    template<typename Disruptor, typename Msg, size_t instance, >
-    class Get
-    {
-    public:
+                Put(const Put&) = delete;
+                Put& operator=(const Put&) = delete;
 
-        Cursor& cursor();
-        Get(Disruptor& ):
-            _begin{
+                ~Put() { _producer.commit(_slot); }
 
-        Msg* _begin;
-        Msg* _end;
+                template<typename T>
+                Put& operator=(T&& rhs)
+                {
+                    **this = std::forward<T>(rhs);
+                    return *this;
+                }
 
-            
-    };
+                Msg& operator*() const
+                {
+                    return _producer._ring[_slot & _producer._mask];
+                }
+                Msg* operator->() const { return &**this; }
+
+            private:
+                Producer& _producer;
+                const Index _slot;
+            };
+
+        private:
+            Cursor& _claimCursor;
+            Cursor& _cursor;
+            Slot* const _ring;
+            const Index _mask;
+            const Index _size;
+            const Barrier _gating;
+            //
+            // Last value seen of the gating barrier.
+            //
+            Index _least;
+
+            Index claim()
+            {
+                Index slot = _claimCursor.fetch_add(
+                    1, std::memory_order_relaxed);
+                Index wrapAt = slot - _size;
+                if(_least <= wrapAt)
+                {
+                    SpinPolicy sp;
+                    while((_least = _gating.least()) <= wrapAt)
+                    {
+                        sp();
+                    }
+                }
+                return slot;
+            }
+
+            void commit(Index slot)
+            {
+                CommitPolicy::template commit<SpinPolicy>(_cursor, slot);
+            }
+        };
+    }
 }
 
 #endif
@@ -0,0 +1,167 @@
+#ifndef AVAILABLE_H
+#define AVAILABLE_H
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "sequence.h"
+
+#include <L3/util/cacheline.h>
+#include <L3/util/futex.h>
+#include <L3/util/types.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+
+namespace L3
+{
+    //
+    // Availability buffer for a disruptor with shared producers. With
+    // CommitPolicy::Shared producers commit in the order they claimed
+    // so one that's descheduled holds up all the others. Here each
+    // producer instead marks its own slots published and never waits
+    // for its peers.
+    //
+    // A slot is marked by storing the lap of the ring its sequence
+    // number is on. Sequence numbers start at size so the first lap
+    // is 1 and the zero initialised flags mean nothing is published.
+    //
+    // Consumers gate on Barrier<AvailabilityBuffer<Disruptor>>. Its
+    // cursor is the end of the contiguous run of published slots,
+    // found by scanning the flags from where the last scan got
+    // to. Disruptor::cursor isn't used.
+    //
+    template<typename Disruptor>
+    struct AvailabilityBuffer
+    {
+        static constexpr size_t size = Disruptor::size;
+        static constexpr Index mask = size - 1;
+
+        static constexpr Index lap(Index slot) { return slot / size; }
+
+        static void publish(Index slot, size_t n)
+        {
+            for(Index end = slot + n; slot < end; ++slot)
+            {
+                std::atomic<Index>& flag = flags[slot & mask];
+                flag.store(lap(slot), std::memory_order_release);
+                waiters.notify(flag);
+            }
+        }
+
+        struct Cursor
+        {
+            Index load(std::memory_order) const
+            {
+                //
+                // Everything before the hint has been seen published
+                // so start from there. Acquiring each flag
+                // synchronises with the producer that wrote the slot.
+                //
+                Index start = hint.load(std::memory_order_acquire);
+                Index end = start;
+                while(flags[end & mask].load(std::memory_order_acquire) ==
+                      lap(end))
+                {
+                    ++end;
+                }
+                //
+                // Move the hint on unless another consumer has
+                // already got further.
+                //
+                while(end > start &&
+                      !hint.compare_exchange_weak(
+                          start,
+                          end,
+                          std::memory_order_release,
+                          std::memory_order_acquire))
+                {
+                }
+                return end;
+            }
+            //
+            // Park on the flag of the first slot not yet published.
+            //
+            void wait(Index seen, std::chrono::nanoseconds timeout) const
+            {
+                std::atomic<Index>& flag = flags[seen & mask];
+                Index old = flag.load(std::memory_order_relaxed);
+                if(old != lap(seen))
+                {
+                    waiters.wait(flag, old, timeout);
+                }
+            }
+            //
+            // Wake anyone parked without publishing anything. Waiters
+            // park on the first slot not yet published, which is
+            // where the last scan left the hint. Anyone parked
+            // elsewhere wakes when their timeout expires.
+            //
+            void notify() const
+            {
+                Index end = hint.load(std::memory_order_acquire);
+                waiters.notify(flags[end & mask]);
+            }
+        };
+
+        static Cursor cursor;
+        static Futex::Waiters waiters;
+        L3_CACHE_LINE static Counter hint;
+        L3_CACHE_LINE static std::atomic<Index> flags[size];
+    };
+
+    template<typename Disruptor>
+    typename AvailabilityBuffer<Disruptor>::Cursor
+    AvailabilityBuffer<Disruptor>::cursor;
+
+    template<typename Disruptor>
+    Futex::Waiters AvailabilityBuffer<Disruptor>::waiters;
+
+    template<typename Disruptor>
+    L3_CACHE_LINE Counter AvailabilityBuffer<Disruptor>::hint{Disruptor::size};
+
+    template<typename Disruptor>
+    L3_CACHE_LINE std::atomic<Index>
+    AvailabilityBuffer<Disruptor>::flags[AvailabilityBuffer<Disruptor>::size];
+
+    namespace CommitPolicy
+    {
+        //
+        // Shared producers that commit through an
+        // AvailabilityBuffer. Consumers must gate on
+        // Barrier<AvailabilityBuffer<Disruptor>>.
+        //
+        struct Available
+        {
+            template<typename Disruptor, typename SpinPolicy>
+            static void commit(Index slot, size_t n)
+            {
+                AvailabilityBuffer<Disruptor>::publish(slot, n);
+            }
+            static constexpr std::memory_order order{std::memory_order_relaxed};
+        };
+    }
+}
+
+#endif
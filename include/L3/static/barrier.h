@@ -26,6 +26,11 @@ SOFTWARE.
 
 #include "sequence.h"
 
+#include <L3/util/cacheline.h>
+
+#include <chrono>
+#include <type_traits>
+
 namespace L3
 {
     template<typename...> struct Barrier;
@@ -37,6 +42,18 @@ namespace L3
         {
             return T::cursor.load(std::memory_order_acquire);
         }
+        //
+        // Park on the cursor holding the barrier at seen.
+        //
+        static void wait(Index seen, std::chrono::nanoseconds timeout)
+        {
+            T::cursor.wait(seen, timeout);
+        }
+        //
+        // Wake anyone parked on the cursors without moving them, eg
+        // so they notice they've been halted.
+        //
+        static void notify() { T::cursor.notify(); }
     };
 
     template<typename Head, typename... Tail>
@@ -48,7 +65,101 @@ namespace L3
                 Head::cursor.load(std::memory_order_acquire),
                 Barrier<Tail...>::least());
         }
+
+        static void wait(Index seen, std::chrono::nanoseconds timeout)
+        {
+            if(Head::cursor.load(std::memory_order_relaxed) <= seen)
+            {
+                Head::cursor.wait(seen, timeout);
+            }
+            else
+            {
+                Barrier<Tail...>::wait(seen, timeout);
+            }
+        }
+
+        static void notify()
+        {
+            Head::cursor.notify();
+            Barrier<Tail...>::notify();
+        }
     };
+    //
+    // Barrier for many cursors. Barrier::least() is a chain of
+    // std::min, each depending on the last, so takes time
+    // proportional to the number of cursors however many loads the
+    // CPU could have in flight. Here the cursors are reduced as a
+    // balanced tree of branchless mins. Loads are independent and the
+    // dependency chain is only log2 of the number of cursors deep.
+    //
+    // That only pays when the loads miss, ie the cursors are being
+    // moved by consumers on other cores. Uncontended cursors stay
+    // in cache and the plain Barrier is as quick or quicker. See
+    // test/test_widebarrier.cpp.
+    //
+    template<typename... Ts>
+    struct WideBarrier: Barrier<Ts...>
+    {
+        static constexpr size_t size = sizeof...(Ts);
+
+        static Index least() { return least<0, size>(); }
+
+    private:
+        template<size_t begin, size_t end>
+        using IfOne = typename std::enable_if<end - begin == 1, Index>::type;
+
+        template<size_t begin, size_t end>
+        using IfMany = typename std::enable_if<(end - begin > 1), Index>::type;
+
+        template<size_t begin, size_t end>
+        static IfOne<begin, end> least()
+        {
+            return cursors[begin]->load(std::memory_order_acquire);
+        }
+
+        template<size_t begin, size_t end>
+        static IfMany<begin, end> least()
+        {
+            Index lhs = least<begin, (begin + end) / 2>();
+            Index rhs = least<(begin + end) / 2, end>();
+            return rhs < lhs ? rhs : lhs;
+        }
+
+        static constexpr const Sequence* cursors[size] = { &Ts::cursor... };
+    };
+
+    template<typename... Ts>
+    constexpr const Sequence* WideBarrier<Ts...>::cursors[];
+
+    //
+    // The last value of Barrier::least() seen by Owner. Cursors only
+    // move forward so this is a lower bound on the barrier. Reading
+    // it touches a line only Owner writes, so Owner need only go to
+    // the cursors, which other cores are writing, when the cached
+    // value says it would otherwise have to wait.
+    //
+    // Owner's update() releases what its read of the cursors
+    // acquired so that for shared producers whoever uses the cached
+    // value is synchronised with the consumers it came from.
+    //
+    template<typename Barrier, typename Owner>
+    struct CachedBarrier
+    {
+        static Index least()
+        {
+            return cache.load(std::memory_order_acquire);
+        }
+
+        static void update(Index least)
+        {
+            cache.store(least, std::memory_order_release);
+        }
+
+        L3_CACHE_LINE static Counter cache;
+    };
+
+    template<typename Barrier, typename Owner>
+    L3_CACHE_LINE Counter CachedBarrier<Barrier, Owner>::cache{0};
 }
 
 #endif
@@ -0,0 +1,119 @@
+#ifndef BLOCKPUT_H
+#define BLOCKPUT_H
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "put.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+namespace L3
+{
+    //
+    // Producer side buffer for shared producers. Rather than each
+    // message doing a fetch_add on the shared claim cursor, messages
+    // are collected locally and published K at a time through
+    // Put::Batch. That's one contended atomic per block instead of
+    // one per message at the cost of a producer's messages arriving
+    // in runs rather than interleaved with everyone else's.
+    //
+    // Each producer thread should have its own BlockPut. Buffered
+    // messages are published when the block fills, on flush(), on
+    // poll() once the oldest has waited for longer than maxAge and
+    // when the BlockPut is destroyed. A producer that may go quiet
+    // should either flush() when it has nothing more to send or call
+    // poll() from its idle loop.
+    //
+    template<typename Put,
+             size_t K,
+             typename Clock=std::chrono::steady_clock>
+    class BlockPut
+    {
+    public:
+        using Msg = typename Put::Msg;
+        using Duration = typename Clock::duration;
+
+        static_assert(K > 0, "Empty block");
+        static_assert(K <= detail::RingSize<Put>::value,
+                      "Block larger than ring");
+
+        BlockPut(Duration maxAge = Duration::max()):
+            _maxAge(maxAge),
+            _size(0)
+        {}
+
+        BlockPut(const BlockPut&) = delete;
+        BlockPut& operator=(const BlockPut&) = delete;
+
+        ~BlockPut() { flush(); }
+
+        template<typename T>
+        void put(T&& msg)
+        {
+            if(_size == 0 && _maxAge != Duration::max())
+            {
+                _oldest = Clock::now();
+            }
+            _block[_size++] = std::forward<T>(msg);
+            if(_size == K)
+            {
+                flush();
+            }
+        }
+
+        void flush()
+        {
+            if(_size)
+            {
+                typename Put::Batch(&_block[0], &_block[0] + _size);
+                _size = 0;
+            }
+        }
+        //
+        // Flush if the oldest buffered message has been waiting too
+        // long. Returns true if anything was published.
+        //
+        bool poll()
+        {
+            if(_size && Clock::now() - _oldest >= _maxAge)
+            {
+                flush();
+                return true;
+            }
+            return false;
+        }
+
+        size_t size() const { return _size; }
+
+    private:
+        std::array<Msg, K> _block;
+        const Duration _maxAge;
+        typename Clock::time_point _oldest;
+        size_t _size;
+    };
+}
+
+#endif
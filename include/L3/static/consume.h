@@ -1,27 +1,203 @@
 #ifndef CONSUME_H
 #define CONSUME_H
 
+#include <L3/util/types.h>
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
 namespace L3
 {
+    namespace detail
+    {
+        template<typename F>
+        auto endOfBatch(F& f, int) -> decltype(f.endOfBatch())
+        {
+            return f.endOfBatch();
+        }
+
+        template<typename F>
+        void endOfBatch(F&, long)
+        {
+        }
+    }
     //
-    // General purpose consumer loop.
+    // Tell a handler it has seen the last message of a batch if it
+    // has an endOfBatch() to say it wants to know, eg to publish
+    // something it has been accumulating.
     //
-    template<typename Get, typename F, typename EOS>
-    inline void
-    consume(EOS& checkEOS, const F& f)
+    template<typename F>
+    inline void endOfBatch(F& f)
+    {
+        detail::endOfBatch(f, 0);
+    }
+
+    //
+    // How a handler takes messages. Handlers take one message at a
+    // time, f(msg), unless they say otherwise with a nested type
+    //
+    //     using Handles = L3::Handles::Events;
+    //
+    // or wrap a callable with L3::events() or L3::batches().
+    //
+    namespace Handles
     {
-        for(;;)
+        //
+        // f(msg) for each message then endOfBatch() if f has one.
+        //
+        struct Messages {};
+        //
+        // f(msg, sequence, endOfBatch) for each message with its
+        // sequence number and whether it's the last of the batch, as
+        // for the LMAX onEvent(). Sequence numbers start at the
+        // ring's size.
+        //
+        struct Events {};
+        //
+        // f(batch) once for each non empty batch. Anything with
+        // begin() and end(), eg for L3::spans().
+        //
+        struct Batches {};
+    }
+
+    namespace detail
+    {
+        template<typename T> struct Void { using type = void; };
+
+        template<typename F, typename = void>
+        struct HandlesOf { using type = Handles::Messages; };
+
+        template<typename F>
+        struct HandlesOf<F, typename Void<typename F::Handles>::type>
         {
-            for(auto msg: Get())
+            using type = typename F::Handles;
+        };
+
+        template<typename F, typename Batch, typename Stop>
+        bool handle(F& f, const Batch& batch, Stop& stop, Handles::Batches)
+        {
+            if(batch.begin() == batch.end())
             {
-                f(msg);
+                return false;
+            }
+            f(batch);
+            bool stopped = false;
+            for(auto& msg: batch)
+            {
+                stopped = stopped || stop(msg);
+            }
+            return stopped;
+        }
 
-                if(checkEOS(msg))
+        template<typename F, typename Batch, typename Stop>
+        bool handle(F& f, const Batch& batch, Stop& stop, Handles::Events)
+        {
+            for(auto i = batch.begin(), end = batch.end(); i != end;)
+            {
+                auto& msg = *i;
+                Index sequence = Index(i);
+                bool stopping = stop(msg);
+                f(msg, sequence, stopping || ++i == end);
+                if(stopping)
                 {
-                    return;
+                    return true;
                 }
             }
+            return false;
+        }
+
+        template<typename F, typename Batch, typename Stop>
+        bool handle(F& f, const Batch& batch, Stop& stop, Handles::Messages)
+        {
+            if(batch.begin() == batch.end())
+            {
+                return false;
+            }
+            for(auto& msg: batch)
+            {
+                f(msg);
+                if(stop(msg))
+                {
+                    L3::endOfBatch(f);
+                    return true;
+                }
+            }
+            L3::endOfBatch(f);
+            return false;
+        }
+
+        struct Never
+        {
+            template<typename Msg>
+            bool operator()(const Msg&) const { return false; }
+        };
+        //
+        // A callable opted in to taking messages some other way.
+        //
+        template<typename F, typename H>
+        struct Opted
+        {
+            using Handles = H;
+            F f;
+
+            template<typename... Args>
+            void operator()(Args&&... args) { f(std::forward<Args>(args)...); }
+        };
+    }
+    //
+    // Eg consume<Get>(eos, L3::batches([](const Get& b) { ... })).
+    //
+    template<typename F>
+    inline detail::Opted<typename std::decay<F>::type, Handles::Events>
+    events(F&& f)
+    {
+        return {std::forward<F>(f)};
+    }
+
+    template<typename F>
+    inline detail::Opted<typename std::decay<F>::type, Handles::Batches>
+    batches(F&& f)
+    {
+        return {std::forward<F>(f)};
+    }
+    //
+    // Hand a batch from a Get to a handler in the way it takes them,
+    // chosen at compile time so plain handlers cost no more than a
+    // loop calling them.
+    //
+    // stop(msg) is asked about each message. Once it says true no
+    // more messages are handed over, that message is treated as the
+    // end of the batch and handle() returns true. A whole batch
+    // handler has already seen every message.
+    //
+    template<typename F, typename Batch, typename Stop>
+    inline bool handle(F& f, const Batch& batch, Stop& stop)
+    {
+        using H = typename detail::HandlesOf<
+            typename std::remove_const<F>::type>::type;
+        return detail::handle(f, batch, stop, H());
+    }
+
+    template<typename F, typename Batch>
+    inline void handle(F& f, const Batch& batch)
+    {
+        detail::Never never;
+        handle(f, batch, never);
+    }
+    //
+    // General purpose consumer loop. Handlers can take messages in
+    // any of the ways handle() supports. Whatever a lazy Get
+    // hasn't released yet is released on the way out.
+    //
+    template<typename Get, typename F, typename EOS>
+    inline void
+    consume(EOS& checkEOS, F&& f)
+    {
+        while(!handle(f, Get(), checkEOS))
+        {
         }
+        Get::flush();
     }
 
     template<typename Msg, Msg eos>
@@ -24,8 +24,11 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include "available.h"
 #include "barrier.h"
 #include "get.h"
+#include "layout.h"
+#include "prefetch.h"
 #include "put.h"
 #include "sequence.h"
 
@@ -34,13 +37,17 @@ SOFTWARE.
 
 namespace L3 // Low Latency Library
 {
-    template<typename T, size_t s, typename TAG=void>
+    template<typename T,
+             size_t s,
+             typename TAG=void,
+             typename LAYOUT=LayoutPolicy::CacheLinePadded>
     struct Disruptor
     {
-        using DISRUPTOR = Disruptor<T, s, TAG>;
+        using DISRUPTOR = Disruptor<T, s, TAG, LAYOUT>;
         using Msg = T;
         using Tag = TAG;
-        using Ring = L3::Ring<CacheLine<Msg>, s>;
+        using Layout = LAYOUT;
+        using Ring = typename Layout::template Ring<Msg, s>;
         static const size_t size = Ring::size;
         L3_CACHE_LINE static Ring ring;
         
@@ -50,8 +57,15 @@ namespace L3 // Low Latency Library
 
         template<typename Tag=void,
                  typename BARRIER=Barrier<DISRUPTOR>,
-                 typename SpinPolicy=NoOp>
-        using Get = Get<DISRUPTOR, Tag, BARRIER, SpinPolicy>;
+                 typename SpinPolicy=NoOp,
+                 typename PrefetchPolicy=PrefetchPolicy::None,
+                 typename PublishPolicy=PublishPolicy::Eager>
+        using Get = Get<DISRUPTOR,
+                        Tag,
+                        BARRIER,
+                        SpinPolicy,
+                        PrefetchPolicy,
+                        PublishPolicy>;
 
         template<typename BARRIER=Barrier<Get<>>,
                  typename COMMITPOLICY=CommitPolicy::Unique,
@@ -64,13 +78,14 @@ namespace L3 // Low Latency Library
                             CommitSpinPolicy>;
     };
 
-    template<typename T, size_t s, typename Tag>
-    L3_CACHE_LINE typename Disruptor<T, s, Tag>::Ring
-    Disruptor<T, s, Tag>::ring;
+    template<typename T, size_t s, typename Tag, typename Layout>
+    L3_CACHE_LINE typename Disruptor<T, s, Tag, Layout>::Ring
+    Disruptor<T, s, Tag, Layout>::ring;
 
-    template<typename T, size_t s, typename Tag>
+    template<typename T, size_t s, typename Tag, typename Layout>
     L3_CACHE_LINE L3::Sequence
-    Disruptor<T, s, Tag>::cursor{Disruptor<T, s, Tag>::Ring::size};
+    Disruptor<T, s, Tag, Layout>::cursor{
+        Disruptor<T, s, Tag, Layout>::Ring::size};
 }
 
 #endif
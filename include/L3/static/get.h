@@ -24,55 +24,148 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include "barrier.h"
+#include "prefetch.h"
 #include "sequence.h"
+#include "spinpolicy.h"
 
 #include <L3/util/cacheline.h>
 
+#include <chrono>
 #include <limits>
 
 namespace L3
 {
+    //
+    // When a Get releases its cursor. Every store of the cursor
+    // pulls its cache line away from the producer, and anyone gated
+    // on the Get, which must then fetch it back in Barrier::least().
+    // With small batches that can cost more than the messages.
+    //
+    namespace PublishPolicy
+    {
+        //
+        // Release the cursor at the end of every batch.
+        //
+        struct Eager {};
+        //
+        // Only release the cursor once every messages have been
+        // consumed since it was last released, or once the ring, as
+        // far as the Get last saw it, is at least percent full
+        // counting from the released cursor. Otherwise the Get keeps
+        // its position to itself.
+        //
+        // Whatever hasn't been released is released as soon as the
+        // Get finds nothing to do, ie before it blocks or returns an
+        // empty batch. So a producer waiting to wrap onto slots the
+        // consumer is done with always gets them: either the
+        // consumer has more to do and will reach every or percent,
+        // or it's idle and has released everything.
+        //
+        // That only holds if the consumer keeps coming back for
+        // more. If it waits on anything else call Get::flush()
+        // first, and call it when it stops consuming for good.
+        //
+        template<size_t every=64, size_t percent=50>
+        struct Lazy
+        {
+            static_assert(every > 0, "Must release every so often");
+            static_assert(percent > 0 && percent <= 100,
+                          "Occupancy is a percentage of the ring");
+
+            static bool due(Index released, Index end, Index head,
+                            size_t size)
+            {
+                return end - released >= every ||
+                    (head - released) * 100 >= size * percent;
+            }
+        };
+    }
+    //
+    // A consumer's batch of messages. Slots are handed out by
+    // reference so a consumer may update messages in place, eg to
+    // annotate them for the stages after it, rather than copy them
+    // into another disruptor. That's safe as long as no other
+    // consumer reads the slots meanwhile: every other consumer of
+    // the ring must either be in this one's barrier, directly or
+    // not, or gate on it. Pipeline checks this for stages that
+    // Write.
+    //
+    // Writes made through a Get happen before its destructor stores
+    // the cursor with release semantics. Consumers gated on it load
+    // the cursor with acquire semantics in Barrier::least() so see
+    // the writes, as does the producer before reusing the slot.
+    // Nothing is visible downstream until the whole batch is
+    // released, and with PublishPolicy::Lazy not until the cursor
+    // is.
+    //
     template<typename Disruptor,
              typename Tag,
              typename Barrier,
-             typename SpinPolicy=NoOp>
+             typename SpinPolicy=NoOp,
+             typename PrefetchPolicy=PrefetchPolicy::None,
+             typename PublishPolicy=PublishPolicy::Eager>
     struct Get
     {
         Get():
             //
             // Only a single thread should be modifying the read cursor.
             //
-            _begin{cursor.load(std::memory_order_relaxed)},
+            _begin{position(PublishPolicy())},
             _end{claim(_begin)}
         {}
         
         Get(size_t maxBatchSize):
-            _begin{cursor.load(std::memory_order_relaxed)},
-            _end{std::min(claim(_begin), _begin + maxBatchSize)}
+            _begin{position(PublishPolicy())},
+            _end{std::min(claim(_begin), Index(_begin) + maxBatchSize)}
         {
         }
 
         enum NoBlock { noBlock };
         Get(size_t maxBatchSize, NoBlock):
-            _begin(cursor.load(std::memory_order_relaxed)),
-            _end(std::min(Barrier::least(), _begin + maxBatchSize))
+            _begin(position(PublishPolicy())),
+            _end(std::min(available(_begin), Index(_begin) + maxBatchSize))
         {
         }
 
         Get(NoBlock):
-            _begin(cursor.load(std::memory_order_relaxed)),
-            _end(Barrier::least())
+            _begin(position(PublishPolicy())),
+            _end(available(_begin))
+        {}
+        //
+        // Block until there are messages or the deadline passes. In
+        // the latter case the batch is empty.
+        //
+        template<typename Clock, typename Duration>
+        Get(const std::chrono::time_point<Clock, Duration>& deadline):
+            _begin{position(PublishPolicy())},
+            _end{claim(_begin, [&]{ return Clock::now() >= deadline; })}
+        {}
+
+        template<typename Clock, typename Duration>
+        Get(size_t maxBatchSize,
+            const std::chrono::time_point<Clock, Duration>& deadline):
+            _begin{position(PublishPolicy())},
+            _end{std::min(
+                    claim(_begin, [&]{ return Clock::now() >= deadline; }),
+                    Index(_begin) + maxBatchSize)}
         {}
         
         ~Get()
         {
             if(_begin != _end)
             {
-                cursor.store(_end, std::memory_order_release);
+                release(PublishPolicy(), _end);
             }
         }
+        //
+        // Release anything consumed but not yet released. Only needed
+        // with PublishPolicy::Lazy.
+        //
+        static void flush() { flush(PublishPolicy()); }
 
-        using Iterator = typename Disruptor::Iterator;
+        using Iterator = typename PrefetchPolicy::template Iterator<
+            typename Disruptor::Iterator>;
         Iterator begin() const { return _begin; }
         Iterator end() const { return _end; }
 
@@ -87,20 +180,126 @@ namespace L3
             _end(e)
         {}
         
+        using Cache = CachedBarrier<Barrier, Get>;
+        using Eager = L3::PublishPolicy::Eager;
+
+        static Index position(Eager)
+        {
+            return cursor.load(std::memory_order_relaxed);
+        }
+
+        static void release(Eager, Index end)
+        {
+            publish(end);
+        }
+
+        static void flush(Eager) {}
+        //
+        // A lazy Get's position is only in local, which is never
+        // shared, until it's due for release.
+        //
+        template<typename Lazy>
+        static Index position(Lazy) { return local; }
+
+        template<typename Lazy>
+        static void release(Lazy, Index end)
+        {
+            local = end;
+            if(Lazy::due(cursor.load(std::memory_order_relaxed),
+                         end,
+                         Cache::least(),
+                         Disruptor::size))
+            {
+                publish(end);
+            }
+        }
+
+        template<typename Lazy>
+        static void flush(Lazy)
+        {
+            if(cursor.load(std::memory_order_relaxed) != local)
+            {
+                publish(local);
+            }
+        }
+
+        static void publish(Index end)
+        {
+            cursor.store(end, std::memory_order_release);
+            cursor.notify();
+        }
+
+        L3_CACHE_LINE static Index local;
+        //
+        // End of what's available without blocking. If the last look
+        // at the barrier is still ahead of us there's no need to look
+        // again.
+        //
+        static Index available(Index begin)
+        {
+            Index end = Cache::least();
+            if(end <= begin)
+            {
+                end = Barrier::least();
+                Cache::update(end);
+                if(end <= begin)
+                {
+                    flush();
+                }
+            }
+            return end;
+        }
+
         static Index claim(Index begin)
         {
+            Index end = Cache::least();
+            if(end > begin)
+            {
+                return end;
+            }
             //
             // The cursor is the start of a dependency chain
             // leading to reading a message from the ring
             // buffer. Therefore consume semantics are sufficient to
             // ensure synchronisation.
             //
-            Index end;
             SpinPolicy sp;
-            while((end = Barrier::least()) <= begin)
+            if((end = Barrier::least()) <= begin)
+            {
+                flush();
+                do
+                {
+                    spin<Barrier>(sp, end);
+                }
+                while((end = Barrier::least()) <= begin);
+            }
+            Cache::update(end);
+            return end;
+        }
+
+        template<typename Expired>
+        static Index claim(Index begin, Expired expired)
+        {
+            Index end = Cache::least();
+            if(end > begin)
+            {
+                return end;
+            }
+            SpinPolicy sp;
+            if((end = Barrier::least()) <= begin)
             {
-                sp();
+                flush();
             }
+            while(end <= begin)
+            {
+                if(expired())
+                {
+                    return begin;
+                }
+                spin<Barrier>(sp, end);
+                end = Barrier::least();
+            }
+            Cache::update(end);
             return end;
         }
     };
@@ -108,9 +307,22 @@ namespace L3
     template<typename Disruptor,
              typename Tag,
              typename Barrier,
-             typename SpinPolicy>
+             typename SpinPolicy,
+             typename PrefetchPolicy,
+             typename PublishPolicy>
     L3_CACHE_LINE L3::Sequence
-    Get<Disruptor, Tag, Barrier, SpinPolicy>::cursor{Disruptor::size};
+    Get<Disruptor, Tag, Barrier, SpinPolicy, PrefetchPolicy, PublishPolicy>::
+    cursor{Disruptor::size};
+
+    template<typename Disruptor,
+             typename Tag,
+             typename Barrier,
+             typename SpinPolicy,
+             typename PrefetchPolicy,
+             typename PublishPolicy>
+    L3_CACHE_LINE Index
+    Get<Disruptor, Tag, Barrier, SpinPolicy, PrefetchPolicy, PublishPolicy>::
+    local{Disruptor::size};
 }
 
 #endif
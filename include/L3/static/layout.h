@@ -0,0 +1,107 @@
+#ifndef LAYOUT_H
+#define LAYOUT_H
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <L3/util/cacheline.h>
+#include <L3/util/ring.h>
+#include <L3/util/soaring.h>
+
+#include <cstddef>
+
+namespace L3
+{
+    //
+    // How messages are laid out in a disruptor's ring. Each policy
+    // gives the type of ring holding messages of type T.
+    //
+    namespace LayoutPolicy
+    {
+        //
+        // One message per cache line. Producers and consumers working
+        // on neighbouring slots never share a line but a ring of small
+        // messages is mostly padding.
+        //
+        struct CacheLinePadded
+        {
+            template<typename T>
+            using Slot = CacheLine<T>;
+
+            template<typename T, size_t log2size>
+            using Ring = L3::Ring<Slot<T>, log2size>;
+        };
+        //
+        // Messages at their natural alignment. Smallest ring and a
+        // consumer reading a batch streams through memory. Slots near
+        // the head and tail can share cache lines.
+        //
+        struct Packed
+        {
+            template<typename T>
+            using Slot = T;
+
+            template<typename T, size_t log2size>
+            using Ring = L3::Ring<Slot<T>, log2size>;
+        };
+        //
+        // K messages to a cache line. Each slot is aligned to
+        // cache_line_size / K so messages never straddle lines.
+        //
+        template<size_t K>
+        struct Grouped
+        {
+            static_assert(K && !(K & (K - 1)), "K must be a power of 2");
+            static_assert(K <= cache_line_size, "Too many per line");
+
+            static constexpr size_t alignment = cache_line_size / K;
+
+            template<typename T>
+            struct Check
+            {
+                static_assert(sizeof(T) <= alignment,
+                              "Message too big to group K per line");
+                using type = Aligned<T, alignment>;
+            };
+
+            template<typename T>
+            using Slot = typename Check<T>::type;
+
+            template<typename T, size_t log2size>
+            using Ring = L3::Ring<Slot<T>, log2size>;
+        };
+        //
+        // Struct of arrays. T must be a std::tuple and each field is
+        // kept in its own array. Puts assign tuples and Gets iterate
+        // over tuples of references. Use L3::column to get at the
+        // contiguous fields of a batch.
+        //
+        struct SoA
+        {
+            template<typename T, size_t log2size>
+            using Ring = SoARing<T, log2size>;
+        };
+    }
+}
+
+#endif
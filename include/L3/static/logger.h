@@ -41,7 +41,11 @@ namespace L3 // Low Latency Library
         Logger(): os() {}
         ~Logger()
         {
-            Put() = std::move(os.str());
+            //
+            // str() gives us a temporary which is moved into the
+            // slot rather than copied.
+            //
+            Put() = os.str();
         }
 
         template<typename T>
@@ -0,0 +1,397 @@
+#ifndef OPERATORS_H
+#define OPERATORS_H
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "consume.h"
+
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace L3
+{
+    //
+    // Cheap transforms fused into one handler. Rather than a stage
+    // per transform, each with its own disruptor and a hand off
+    // between cores, operators are composed with | at compile time
+    // and the result ends in a sink, any callable:
+    //
+    //     using namespace L3::Op;
+    //     auto handler = map([](Msg m){ return m.price; })
+    //                  | filter([](double p){ return p > 0; })
+    //                  | tumbling(100, 0.0, std::plus<double>())
+    //                  | [&](double total){ ... };
+    //     L3::consume<Get>(checkEOS, handler);
+    //
+    // Each message goes through every operator while it's in cache
+    // and calls between operators are inlined.
+    //
+    // Operators hold state so a handler should be used by one
+    // consumer. Those that emit per batch rely on endOfBatch(), which
+    // handle() calls.
+    //
+    namespace Op
+    {
+        //
+        // Base of everything composable with |.
+        //
+        struct Operator {};
+
+        template<typename F>
+        struct Map: Operator
+        {
+            explicit Map(F f): _f(std::move(f)) {}
+
+            template<typename Next>
+            struct Bound
+            {
+                F f;
+                Next next;
+
+                template<typename T>
+                void operator()(T&& msg) { next(f(std::forward<T>(msg))); }
+
+                void endOfBatch() { L3::endOfBatch(next); }
+            };
+
+            template<typename Next>
+            Bound<Next> bind(Next next) const
+            {
+                return Bound<Next>{_f, std::move(next)};
+            }
+
+        private:
+            F _f;
+        };
+
+        template<typename F>
+        struct Filter: Operator
+        {
+            explicit Filter(F f): _f(std::move(f)) {}
+
+            template<typename Next>
+            struct Bound
+            {
+                F f;
+                Next next;
+
+                template<typename T>
+                void operator()(T&& msg)
+                {
+                    if(f(msg))
+                    {
+                        next(std::forward<T>(msg));
+                    }
+                }
+
+                void endOfBatch() { L3::endOfBatch(next); }
+            };
+
+            template<typename Next>
+            Bound<Next> bind(Next next) const
+            {
+                return Bound<Next>{_f, std::move(next)};
+            }
+
+        private:
+            F _f;
+        };
+        //
+        // Running fold: acc = f(acc, msg), emitting acc every time.
+        //
+        template<typename Acc, typename F>
+        struct Scan: Operator
+        {
+            Scan(Acc init, F f): _init(std::move(init)), _f(std::move(f)) {}
+
+            template<typename Next>
+            struct Bound
+            {
+                Acc acc;
+                F f;
+                Next next;
+
+                template<typename T>
+                void operator()(T&& msg)
+                {
+                    acc = f(acc, std::forward<T>(msg));
+                    next(static_cast<const Acc&>(acc));
+                }
+
+                void endOfBatch() { L3::endOfBatch(next); }
+            };
+
+            template<typename Next>
+            Bound<Next> bind(Next next) const
+            {
+                return Bound<Next>{_init, _f, std::move(next)};
+            }
+
+        private:
+            Acc _init;
+            F _f;
+        };
+        //
+        // Fold every n messages into one, starting each window from
+        // init. Throws std::invalid_argument if n is 0.
+        //
+        template<typename Acc, typename F>
+        struct Tumbling: Operator
+        {
+            Tumbling(size_t n, Acc init, F f):
+                _n(n),
+                _init(std::move(init)),
+                _f(std::move(f))
+            {
+                if(n == 0)
+                {
+                    throw std::invalid_argument("Empty window");
+                }
+            }
+
+            template<typename Next>
+            struct Bound
+            {
+                size_t n;
+                Acc init;
+                F f;
+                Next next;
+                Acc acc;
+                size_t count;
+
+                template<typename T>
+                void operator()(T&& msg)
+                {
+                    acc = f(acc, std::forward<T>(msg));
+                    if(++count == n)
+                    {
+                        next(static_cast<const Acc&>(acc));
+                        acc = init;
+                        count = 0;
+                    }
+                }
+
+                void endOfBatch() { L3::endOfBatch(next); }
+            };
+
+            template<typename Next>
+            Bound<Next> bind(Next next) const
+            {
+                return Bound<Next>{_n, _init, _f, std::move(next), _init, 0};
+            }
+
+        private:
+            size_t _n;
+            Acc _init;
+            F _f;
+        };
+        //
+        // The last N messages, oldest first.
+        //
+        template<typename T, size_t N>
+        class Window
+        {
+        public:
+            static_assert(N > 0, "Empty window");
+
+            size_t size() const { return _count < N ? _count : N; }
+            bool full() const { return _count >= N; }
+
+            const T& operator[](size_t i) const
+            {
+                return _values[(_count - size() + i) % N];
+            }
+
+            const T& front() const { return (*this)[0]; }
+            const T& back() const { return (*this)[size() - 1]; }
+
+            void push(const T& value) { _values[_count++ % N] = value; }
+
+        private:
+            T _values[N];
+            size_t _count{0};
+        };
+        //
+        // Emit the Window of the last N messages for each message
+        // once there have been N.
+        //
+        template<typename T, size_t N>
+        struct Sliding: Operator
+        {
+            template<typename Next>
+            struct Bound
+            {
+                Next next;
+                Window<T, N> window;
+
+                template<typename U>
+                void operator()(U&& msg)
+                {
+                    window.push(std::forward<U>(msg));
+                    if(window.full())
+                    {
+                        next(static_cast<const Window<T, N>&>(window));
+                    }
+                }
+
+                void endOfBatch() { L3::endOfBatch(next); }
+            };
+
+            template<typename Next>
+            Bound<Next> bind(Next next) const
+            {
+                return Bound<Next>{std::move(next), Window<T, N>()};
+            }
+        };
+        //
+        // Fold each batch a consumer gets into one, starting from
+        // init. Emits at the end of any non empty batch. Useful for
+        // conflating, eg keeping only the latest price per batch.
+        //
+        template<typename Acc, typename F>
+        struct Aggregate: Operator
+        {
+            Aggregate(Acc init, F f):
+                _init(std::move(init)),
+                _f(std::move(f))
+            {}
+
+            template<typename Next>
+            struct Bound
+            {
+                Acc init;
+                F f;
+                Next next;
+                Acc acc;
+                bool any;
+
+                template<typename T>
+                void operator()(T&& msg)
+                {
+                    acc = f(acc, std::forward<T>(msg));
+                    any = true;
+                }
+
+                void endOfBatch()
+                {
+                    if(any)
+                    {
+                        next(static_cast<const Acc&>(acc));
+                        acc = init;
+                        any = false;
+                    }
+                    L3::endOfBatch(next);
+                }
+            };
+
+            template<typename Next>
+            Bound<Next> bind(Next next) const
+            {
+                return Bound<Next>{_init, _f, std::move(next), _init, false};
+            }
+
+        private:
+            Acc _init;
+            F _f;
+        };
+        //
+        // First then second.
+        //
+        template<typename First, typename Second>
+        struct Compose: Operator
+        {
+            Compose(First first, Second second):
+                _first(std::move(first)),
+                _second(std::move(second))
+            {}
+
+            template<typename Next>
+            auto bind(Next next) const
+                -> decltype(std::declval<const First&>().bind(
+                                std::declval<const Second&>().bind(
+                                    std::move(next))))
+            {
+                return _first.bind(_second.bind(std::move(next)));
+            }
+
+        private:
+            First _first;
+            Second _second;
+        };
+
+        template<typename F>
+        Map<F> map(F f) { return Map<F>(std::move(f)); }
+
+        template<typename F>
+        Filter<F> filter(F f) { return Filter<F>(std::move(f)); }
+
+        template<typename Acc, typename F>
+        Scan<Acc, F> scan(Acc init, F f)
+        {
+            return Scan<Acc, F>(std::move(init), std::move(f));
+        }
+
+        template<typename Acc, typename F>
+        Tumbling<Acc, F> tumbling(size_t n, Acc init, F f)
+        {
+            return Tumbling<Acc, F>(n, std::move(init), std::move(f));
+        }
+
+        template<typename T, size_t N>
+        Sliding<T, N> sliding() { return Sliding<T, N>(); }
+
+        template<typename Acc, typename F>
+        Aggregate<Acc, F> aggregate(Acc init, F f)
+        {
+            return Aggregate<Acc, F>(std::move(init), std::move(f));
+        }
+
+        template<typename T>
+        using IsOperator = std::is_base_of<Operator, T>;
+        //
+        // Operator | operator is another operator. Operator | anything
+        // else ends the chain and gives a handler.
+        //
+        template<typename A, typename B>
+        typename std::enable_if<IsOperator<A>::value && IsOperator<B>::value,
+                                Compose<A, B>>::type
+        operator|(A a, B b)
+        {
+            return Compose<A, B>(std::move(a), std::move(b));
+        }
+
+        template<typename A, typename Sink>
+        auto operator|(A a, Sink sink)
+            -> typename std::enable_if<
+                IsOperator<A>::value && !IsOperator<Sink>::value,
+                decltype(a.bind(std::move(sink)))>::type
+        {
+            return a.bind(std::move(sink));
+        }
+    }
+}
+
+#endif
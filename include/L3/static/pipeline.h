@@ -0,0 +1,422 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "barrier.h"
+#include "processor.h"
+#include "put.h"
+#include "spinpolicy.h"
+
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace L3
+{
+    //
+    // Describe the consumers of a disruptor and let the barriers be
+    // worked out. Instead of
+    //
+    //     using Get1 = D::Get<Tag<1>>;
+    //     using Get2 = D::Get<Tag<2>>;
+    //     using Get3 = D::Get<Tag<3>, Barrier<Get1, Get2>>;
+    //     using Put = D::Put<Barrier<Get3>, CommitPolicy::Shared>;
+    //
+    // say what each stage comes after
+    //
+    //     using P = Pipeline<D, 2,
+    //                        Stage<C1>,
+    //                        Stage<C2>,
+    //                        Stage<C3, After<C1, C2>>>;
+    //
+    // and use P::Get<C3>, P::Put and P::Threads<>. A stage is named
+    // by its handler type, which is default constructed and called
+    // with each message.
+    //
+    // A stage's barrier is the stages it comes after less any that
+    // another of them already comes after, so After<C1, C3> gates on
+    // C3 alone when C3 comes after C1. Stages that come after
+    // nothing follow the producers. Producers gate on the sinks, the
+    // stages nothing comes after, as between them they're behind
+    // every other stage. With more than one producer the commit
+    // policy is Shared.
+    //
+    // A stage may only come after stages listed before it, which
+    // rules out cycles.
+    //
+    // Stages that update messages in place for later stages, rather
+    // than copying them into another disruptor, are marked Writes,
+    // eg Stage<C3, After<C1, C2>, Writes>. No other stage may read a
+    // slot while it's being written so each other stage must either
+    // come after a writer or be one it comes after. That's checked
+    // at compile time. See Get for the memory ordering.
+    //
+    template<typename... Handlers> struct After {};
+
+    struct Reads {};
+    struct Writes {};
+
+    template<typename Handler,
+             typename Deps = After<>,
+             typename Access = Reads>
+    struct Stage;
+
+    template<typename Handler, typename... Deps, typename Access>
+    struct Stage<Handler, After<Deps...>, Access>
+    {
+        using type = Handler;
+    };
+
+    namespace detail
+    {
+        template<typename...> struct List {};
+
+        template<typename T, typename L> struct Contains;
+
+        template<typename T>
+        struct Contains<T, List<>>: std::false_type {};
+
+        template<typename T, typename H, typename... Ts>
+        struct Contains<T, List<H, Ts...>>:
+            std::integral_constant<
+                bool,
+                std::is_same<T, H>::value || Contains<T, List<Ts...>>::value>
+        {};
+
+        template<typename L, typename In> struct AllContained;
+
+        template<typename In>
+        struct AllContained<List<>, In>: std::true_type {};
+
+        template<typename H, typename... Ts, typename In>
+        struct AllContained<List<H, Ts...>, In>:
+            std::integral_constant<
+                bool,
+                Contains<H, In>::value && AllContained<List<Ts...>, In>::value>
+        {};
+        //
+        // In with later duplicates dropped.
+        //
+        template<typename In, typename Out = List<>> struct Unique;
+
+        template<typename Out>
+        struct Unique<List<>, Out>
+        {
+            using type = Out;
+        };
+
+        template<typename H, typename... Ts, typename... Out>
+        struct Unique<List<H, Ts...>, List<Out...>>:
+            Unique<List<Ts...>,
+                   typename std::conditional<
+                       Contains<H, List<Out...>>::value,
+                       List<Out...>,
+                       List<Out..., H>>::type>
+        {};
+        //
+        // In without X.
+        //
+        template<typename X, typename In, typename Out = List<>>
+        struct Without;
+
+        template<typename X, typename Out>
+        struct Without<X, List<>, Out>
+        {
+            using type = Out;
+        };
+
+        template<typename X, typename H, typename... Ts, typename... Out>
+        struct Without<X, List<H, Ts...>, List<Out...>>:
+            Without<X,
+                    List<Ts...>,
+                    typename std::conditional<
+                        std::is_same<X, H>::value,
+                        List<Out...>,
+                        List<Out..., H>>::type>
+        {};
+        //
+        // Elements T of In for which Keep<T, Context> holds.
+        //
+        template<template<typename, typename> class Keep,
+                 typename Context,
+                 typename In,
+                 typename Out = List<>>
+        struct Filter;
+
+        template<template<typename, typename> class Keep,
+                 typename Context,
+                 typename Out>
+        struct Filter<Keep, Context, List<>, Out>
+        {
+            using type = Out;
+        };
+
+        template<template<typename, typename> class Keep,
+                 typename Context,
+                 typename H,
+                 typename... Ts,
+                 typename... Out>
+        struct Filter<Keep, Context, List<H, Ts...>, List<Out...>>:
+            Filter<Keep,
+                   Context,
+                   List<Ts...>,
+                   typename std::conditional<
+                       Keep<H, Context>::value,
+                       List<Out..., H>,
+                       List<Out...>>::type>
+        {};
+        //
+        // What the stage named Handler comes after.
+        //
+        template<typename Handler, typename Graph> struct DepsOf;
+
+        template<typename Handler,
+                 typename... Deps,
+                 typename Access,
+                 typename... Stages>
+        struct DepsOf<Handler,
+                      List<Stage<Handler, After<Deps...>, Access>,
+                           Stages...>>
+        {
+            using type = List<Deps...>;
+        };
+
+        template<typename Handler, typename S, typename... Stages>
+        struct DepsOf<Handler, List<S, Stages...>>:
+            DepsOf<Handler, List<Stages...>>
+        {};
+        //
+        // Does any stage in Deps come after To, or is it To?
+        //
+        template<typename Graph, typename Deps, typename To>
+        struct Reaches;
+
+        template<typename Graph, typename To>
+        struct Reaches<Graph, List<>, To>: std::false_type {};
+
+        template<typename Graph, typename D, typename... Ds, typename To>
+        struct Reaches<Graph, List<D, Ds...>, To>:
+            std::integral_constant<
+                bool,
+                std::is_same<D, To>::value ||
+                Reaches<Graph, typename DepsOf<D, Graph>::type, To>::value ||
+                Reaches<Graph, List<Ds...>, To>::value>
+        {};
+        //
+        // A dependency is needed unless one of the others comes
+        // after it.
+        //
+        template<typename Graph, typename Deps> struct Context {};
+
+        template<typename X, typename Context> struct Needed;
+
+        template<typename X, typename Graph, typename Deps>
+        struct Needed<X, Context<Graph, Deps>>:
+            std::integral_constant<
+                bool,
+                !Reaches<Graph,
+                         typename Without<X, Deps>::type,
+                         X>::value>
+        {};
+
+        template<typename Graph, typename Deps>
+        using Minimal = typename Filter<
+            Needed,
+            Context<Graph, typename Unique<Deps>::type>,
+            typename Unique<Deps>::type>::type;
+        //
+        // Nothing comes after X.
+        //
+        template<typename X, typename Graph> struct IsSink;
+
+        template<typename X>
+        struct IsSink<X, List<>>: std::true_type {};
+
+        template<typename X,
+                 typename H,
+                 typename... Deps,
+                 typename Access,
+                 typename... Stages>
+        struct IsSink<X, List<Stage<H, After<Deps...>, Access>, Stages...>>:
+            std::integral_constant<
+                bool,
+                !Contains<X, List<Deps...>>::value &&
+                IsSink<X, List<Stages...>>::value>
+        {};
+        //
+        // Each stage comes after stages before it and is listed
+        // once.
+        //
+        template<typename Before, typename Graph>
+        struct Check: std::true_type {};
+
+        template<typename... Before,
+                 typename H,
+                 typename... Deps,
+                 typename Access,
+                 typename... Stages>
+        struct Check<List<Before...>,
+                     List<Stage<H, After<Deps...>, Access>, Stages...>>:
+            Check<List<Before..., H>, List<Stages...>>
+        {
+            static_assert(AllContained<List<Deps...>,
+                                       List<Before...>>::value,
+                          "Stage comes after one not listed before it");
+            static_assert(!Contains<H, List<Before...>>::value,
+                          "Stage listed twice");
+        };
+        //
+        // Every stage in Handlers is W, comes after W or comes
+        // before it.
+        //
+        template<typename Graph, typename W, typename Handlers>
+        struct OrderedWith: std::true_type {};
+
+        template<typename Graph, typename W, typename H, typename... Hs>
+        struct OrderedWith<Graph, W, List<H, Hs...>>:
+            std::integral_constant<
+                bool,
+                (std::is_same<W, H>::value ||
+                 Reaches<Graph, typename DepsOf<H, Graph>::type, W>::value ||
+                 Reaches<Graph, typename DepsOf<W, Graph>::type, H>::value) &&
+                OrderedWith<Graph, W, List<Hs...>>::value>
+        {};
+
+        template<typename Graph, typename Stages = Graph>
+        struct CheckWriters: std::true_type {};
+
+        template<typename Graph,
+                 typename H,
+                 typename... Deps,
+                 typename Access,
+                 typename... Stages>
+        struct CheckWriters<Graph,
+                            List<Stage<H, After<Deps...>, Access>, Stages...>>:
+            CheckWriters<Graph, List<Stages...>>
+        {};
+
+        template<typename... All,
+                 typename H,
+                 typename... Deps,
+                 typename... Stages>
+        struct CheckWriters<List<All...>,
+                            List<Stage<H, After<Deps...>, Writes>, Stages...>>:
+            CheckWriters<List<All...>, List<Stages...>>
+        {
+            static_assert(OrderedWith<List<All...>,
+                                      H,
+                                      List<typename All::type...>>::value,
+                          "Stage writing in place runs alongside another");
+        };
+    }
+
+    template<typename Disruptor, size_t producers, typename... Stages>
+    class Pipeline
+    {
+        static_assert(sizeof...(Stages) > 0, "Pipeline with no stages");
+        static_assert(producers > 0, "Pipeline with no producers");
+
+        using Graph = detail::List<Stages...>;
+        static_assert(detail::Check<detail::List<>, Graph>::value, "");
+        static_assert(detail::CheckWriters<Graph>::value, "");
+
+        template<typename Handlers, typename Dummy = void> struct Gate;
+
+        template<typename Dummy>
+        struct Gate<detail::List<>, Dummy>
+        {
+            using type = Barrier<Disruptor>;
+        };
+
+    public:
+        template<typename Handler>
+        using Get = typename Disruptor::template Get<
+            Handler,
+            typename Gate<
+                detail::Minimal<
+                    Graph,
+                    typename detail::DepsOf<Handler, Graph>::type>>::type>;
+        //
+        // The stages producers gate on.
+        //
+        using Sinks = typename detail::Filter<
+            detail::IsSink,
+            Graph,
+            detail::List<typename Stages::type...>>::type;
+
+        using Commit = typename std::conditional<
+            (producers > 1),
+            CommitPolicy::Shared,
+            CommitPolicy::Unique>::type;
+
+        template<typename ClaimSpinPolicy=NoOp,
+                 typename CommitSpinPolicy=NoOp>
+        using PutWith = typename Disruptor::template Put<
+            typename Gate<Sinks>::type,
+            Commit,
+            ClaimSpinPolicy,
+            CommitSpinPolicy>;
+
+        using Put = PutWith<>;
+        //
+        // A thread for each stage in a Group, added in the order
+        // the stages are listed.
+        //
+        template<typename IdlePolicy=SpinPolicy::Block<>>
+        class Threads
+        {
+        public:
+            Threads()
+            {
+                int expand[] = { 0, (add<typename Stages::type>(), 0)... };
+                (void)expand;
+            }
+
+            bool start() { return _group.start(); }
+            void halt() { _group.halt(); }
+
+        private:
+            std::vector<std::unique_ptr<Runner>> _runners;
+            Group _group;
+
+            template<typename Handler>
+            void add()
+            {
+                _runners.push_back(
+                    makeProcessor<Get<Handler>, IdlePolicy>(Handler()));
+                _group.add(*_runners.back());
+            }
+        };
+
+    private:
+        template<typename... Handlers, typename Dummy>
+        struct Gate<detail::List<Handlers...>, Dummy>
+        {
+            using type = Barrier<Get<Handlers>...>;
+        };
+    };
+}
+
+#endif
@@ -0,0 +1,446 @@
+#ifndef PLANNER_H
+#define PLANNER_H
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "available.h"
+#include "barrier.h"
+#include "get.h"
+#include "processor.h"
+#include "put.h"
+#include "sequence.h"
+
+#include <L3/util/topology.h>
+
+#include <algorithm>
+#include <ostream>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#    include <sched.h>
+#endif
+
+namespace L3
+{
+    //
+    // Work out which thread of a topology should run on which CPU.
+    //
+    // Threads are described by the Gets and Puts they run. Who talks
+    // to whom then follows from the Barrier types: a Get waits on
+    // the cursors in its barrier, a Put waits on the Gets in its
+    // barrier and publishes through the disruptor's cursor, which
+    // is what first consumers wait on. Two threads communicate if
+    // one waits on a cursor the other moves, or if they move the same
+    // one as shared producers do. For examples/complex.cpp
+    //
+    //     L3::Planner planner;
+    //     planner.thread<Put1>("P1")
+    //            .thread<Put1>("P2")
+    //            .thread<Get1>("C1")
+    //            .thread<Get2>("C2")
+    //            .thread<Get3, Put2>("C3")
+    //            .thread<Get4>("C4");
+    //     L3::Plan plan = planner.plan(L3::Topology());
+    //     std::cout << plan;
+    //
+    // then in each thread plan.apply("C1"), or pass
+    // plan.options("C1") to an EventProcessor.
+    //
+    // A plan costs the links between each pair of threads weighted
+    // by how far apart their CPUs are, and the planner looks for a
+    // cheap one. Threads are first laid out most connected first,
+    // each next to the one it talks to most, over CPUs in
+    // Topology::ordered() order. Then pairs of threads, or a thread
+    // and a spare CPU, are swapped while that lowers the cost. SMT
+    // siblings are only used once every core has a thread. With more
+    // threads than CPUs, or if the topology is unknown, CPUs are
+    // handed out round robin.
+    //
+    class Plan
+    {
+    public:
+        struct Assignment
+        {
+            std::string thread;
+            int cpu;
+        };
+
+        Plan(std::vector<Assignment> assignments):
+            _assignments(std::move(assignments))
+        {}
+
+        const std::vector<Assignment>& assignments() const
+        {
+            return _assignments;
+        }
+
+        int cpu(const std::string& thread) const
+        {
+            for(auto& a: _assignments)
+            {
+                if(a.thread == thread)
+                {
+                    return a.cpu;
+                }
+            }
+            throw std::out_of_range("No thread " + thread + " in plan");
+        }
+        //
+        // For a thread run by an EventProcessor.
+        //
+        ThreadOptions options(const std::string& thread,
+                              int priority = 0) const
+        {
+            return ThreadOptions(cpu(thread), priority);
+        }
+        //
+        // Pin the calling thread as planned. False if it couldn't be.
+        //
+        bool apply(const std::string& thread) const
+        {
+#ifdef __linux__
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu(thread), &set);
+            return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+            (void)thread;
+            return false;
+#endif
+        }
+
+        template<typename OS>
+        friend OS& operator<<(OS& os, const Plan& plan)
+        {
+            for(auto& a: plan._assignments)
+            {
+                os << a.thread << ": cpu " << a.cpu << std::endl;
+            }
+            return os;
+        }
+
+    private:
+        std::vector<Assignment> _assignments;
+    };
+
+    namespace detail
+    {
+        //
+        // Cursors are only compared so anything that stands for one
+        // will do, eg an AvailabilityBuffer's.
+        //
+        using Cursors = std::vector<const void*>;
+
+        template<typename Barrier> struct Follows;
+
+        template<typename... Ts>
+        struct Follows<Barrier<Ts...>>
+        {
+            static void add(Cursors& cursors)
+            {
+                cursors.insert(cursors.end(), { &Ts::cursor... });
+            }
+        };
+
+        template<typename... Ts>
+        struct Follows<WideBarrier<Ts...>>: Follows<Barrier<Ts...>> {};
+        //
+        // The cursor a producer's commits move. Producers committing
+        // through an AvailabilityBuffer mark its flags rather than
+        // moving Disruptor::cursor, and consumers gate on the buffer.
+        //
+        template<typename CommitPolicy, typename Disruptor>
+        struct Commits
+        {
+            static const void* cursor() { return &Disruptor::cursor; }
+        };
+
+        template<typename Disruptor>
+        struct Commits<CommitPolicy::Available, Disruptor>
+        {
+            static const void* cursor()
+            {
+                return &AvailabilityBuffer<Disruptor>::cursor;
+            }
+        };
+        //
+        // Cursors a stage moves and the ones it waits on.
+        //
+        template<typename Stage> struct Describe;
+
+        template<typename Disruptor,
+                 typename Tag,
+                 typename Barrier,
+                 typename SpinPolicy,
+                 typename PrefetchPolicy,
+                 typename PublishPolicy>
+        struct Describe<
+            Get<Disruptor,
+                Tag,
+                Barrier,
+                SpinPolicy,
+                PrefetchPolicy,
+                PublishPolicy>>
+        {
+            using Stage = Get<Disruptor,
+                              Tag,
+                              Barrier,
+                              SpinPolicy,
+                              PrefetchPolicy,
+                              PublishPolicy>;
+
+            static void add(Cursors& moves, Cursors& follows)
+            {
+                moves.push_back(&Stage::cursor);
+                Follows<Barrier>::add(follows);
+            }
+        };
+
+        template<typename Disruptor,
+                 typename Barrier,
+                 typename CommitPolicy,
+                 typename ClaimSpinPolicy,
+                 typename CommitSpinPolicy>
+        struct Describe<
+            Put<Disruptor,
+                Barrier,
+                CommitPolicy,
+                ClaimSpinPolicy,
+                CommitSpinPolicy>>
+        {
+            using Stage = Put<Disruptor,
+                              Barrier,
+                              CommitPolicy,
+                              ClaimSpinPolicy,
+                              CommitSpinPolicy>;
+
+            static void add(Cursors& moves, Cursors& follows)
+            {
+                moves.push_back(&Stage::cursor);
+                moves.push_back(Commits<CommitPolicy, Disruptor>::cursor());
+                Follows<Barrier>::add(follows);
+            }
+        };
+    }
+
+    class Planner
+    {
+    public:
+        //
+        // A thread running Stages. Add threads upstream first; ties
+        // are placed in the order added.
+        //
+        template<typename... Stages>
+        Planner& thread(const std::string& name)
+        {
+            Thread t{name, {}, {}};
+            int expand[] = {
+                0, (detail::Describe<Stages>::add(t.moves, t.follows), 0)...
+            };
+            (void)expand;
+            _threads.push_back(t);
+            return *this;
+        }
+        //
+        // How many cursors connect threads a and b.
+        //
+        size_t weight(size_t a, size_t b) const
+        {
+            return links(_threads[a], _threads[b]) +
+                links(_threads[b], _threads[a]) +
+                shared(_threads[a].moves, _threads[b].moves);
+        }
+
+        Plan plan(const Topology& topology) const
+        {
+            const size_t n = _threads.size();
+            std::vector<Topology::Cpu> cpus = topology.ordered();
+            std::vector<Plan::Assignment> assignments;
+            if(!topology.known() || n > cpus.size())
+            {
+                for(size_t i = 0; i < n; ++i)
+                {
+                    assignments.push_back(Plan::Assignment{
+                            _threads[i].name, cpus[i % cpus.size()].id});
+                }
+                return Plan(assignments);
+            }
+            cpus.resize(std::max(n, cores(cpus)));
+            //
+            // slots[t] is the index in cpus of thread t's CPU.
+            //
+            std::vector<size_t> order = connectedOrder();
+            std::vector<size_t> slots(n);
+            for(size_t i = 0; i < n; ++i)
+            {
+                slots[order[i]] = i;
+            }
+            improve(slots, cpus);
+
+            for(size_t i = 0; i < n; ++i)
+            {
+                assignments.push_back(Plan::Assignment{
+                        _threads[i].name, cpus[slots[i]].id});
+            }
+            return Plan(assignments);
+        }
+        //
+        // Cost of running each thread t on cpus[slots[t]]: the links
+        // between each pair of threads weighted by how far apart
+        // their CPUs are.
+        //
+        size_t cost(const std::vector<size_t>& slots,
+                    const std::vector<Topology::Cpu>& cpus) const
+        {
+            static const size_t costs[] = { 0, 1, 1, 2, 4, 8 };
+            size_t result = 0;
+            for(size_t a = 0; a < slots.size(); ++a)
+            {
+                for(size_t b = a + 1; b < slots.size(); ++b)
+                {
+                    result += weight(a, b) * costs[
+                        Topology::distance(cpus[slots[a]], cpus[slots[b]])];
+                }
+            }
+            return result;
+        }
+
+    private:
+        struct Thread
+        {
+            std::string name;
+            detail::Cursors moves;
+            detail::Cursors follows;
+        };
+        std::vector<Thread> _threads;
+
+        static size_t shared(const detail::Cursors& a,
+                             const detail::Cursors& b)
+        {
+            size_t result = 0;
+            for(auto c: a)
+            {
+                result += std::count(b.begin(), b.end(), c);
+            }
+            return result;
+        }
+
+        static size_t links(const Thread& from, const Thread& to)
+        {
+            return shared(from.moves, to.follows);
+        }
+
+        static size_t cores(const std::vector<Topology::Cpu>& cpus)
+        {
+            std::set<std::pair<int, int>> result;
+            for(auto& c: cpus)
+            {
+                result.insert(std::make_pair(c.package, c.core));
+            }
+            return result.size();
+        }
+        //
+        // Move each thread to whichever CPU lowers the cost most,
+        // swapping with the thread already there if there is one,
+        // until no move helps.
+        //
+        void improve(std::vector<size_t>& slots,
+                     const std::vector<Topology::Cpu>& cpus) const
+        {
+            size_t best = cost(slots, cpus);
+            for(bool better = true; better;)
+            {
+                better = false;
+                for(size_t t = 0; t < slots.size(); ++t)
+                {
+                    for(size_t slot = 0; slot < cpus.size(); ++slot)
+                    {
+                        std::vector<size_t> trial(slots);
+                        auto other = std::find(trial.begin(),
+                                               trial.end(),
+                                               slot);
+                        if(other != trial.end())
+                        {
+                            *other = trial[t];
+                        }
+                        trial[t] = slot;
+                        size_t c = cost(trial, cpus);
+                        if(c < best)
+                        {
+                            best = c;
+                            slots.swap(trial);
+                            better = true;
+                        }
+                    }
+                }
+            }
+        }
+        //
+        // Most connected thread first, then repeatedly whichever
+        // unplaced thread has most links to those already placed.
+        //
+        std::vector<size_t> connectedOrder() const
+        {
+            const size_t n = _threads.size();
+            std::vector<size_t> result;
+            std::vector<bool> placed(n, false);
+            std::vector<size_t> score(n, 0);
+            for(size_t i = 0; i < n; ++i)
+            {
+                for(size_t j = 0; j < n; ++j)
+                {
+                    score[i] += i == j ? 0 : weight(i, j);
+                }
+            }
+            while(result.size() < n)
+            {
+                size_t best = n;
+                for(size_t i = 0; i < n; ++i)
+                {
+                    if(!placed[i] && (best == n || score[i] > score[best]))
+                    {
+                        best = i;
+                    }
+                }
+                placed[best] = true;
+                result.push_back(best);
+                for(size_t i = 0; i < n; ++i)
+                {
+                    score[i] = 0;
+                    for(size_t j: result)
+                    {
+                        score[i] += i == j ? 0 : weight(i, j);
+                    }
+                }
+            }
+            return result;
+        }
+    };
+}
+
+#endif
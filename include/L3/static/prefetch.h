@@ -0,0 +1,97 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <L3/util/cacheline.h>
+#include <L3/util/types.h>
+
+#include <cstddef>
+#include <iterator>
+
+namespace L3
+{
+    //
+    // Software prefetch for consumers iterating over a batch. Worth
+    // having when messages are a cache line or more and the consumer
+    // is waiting on memory rather than doing work.
+    //
+    namespace PrefetchPolicy
+    {
+        //
+        // Iterate over the ring as is.
+        //
+        struct None
+        {
+            template<typename Base>
+            using Iterator = Base;
+        };
+        //
+        // Each increment prefetches every line of the message
+        // distance slots ahead. Locality is as for
+        // __builtin_prefetch, 0 (none) to 3 (keep in all caches).
+        //
+        template<typename Base, size_t distance, int locality>
+        struct PrefetchIterator: Base
+        {
+            using value_type = typename std::iterator_traits<Base>::value_type;
+
+            PrefetchIterator(Index i): Base(i) {}
+            PrefetchIterator(const Base& b): Base(b) {}
+
+            PrefetchIterator& operator++()
+            {
+                const char* p = reinterpret_cast<const char*>(
+                    &static_cast<const Base&>(*this)[distance]);
+                for(size_t line = 0;
+                    line < sizeof(value_type);
+                    line += cache_line_size)
+                {
+                    __builtin_prefetch(p + line, 0, locality);
+                }
+                Base::operator++();
+                return *this;
+            }
+
+            PrefetchIterator operator++(int)
+            {
+                PrefetchIterator result{*this};
+                ++*this;
+                return result;
+            }
+        };
+
+        template<size_t distance, int locality=3>
+        struct Ahead
+        {
+            static_assert(distance > 0, "Prefetching the current slot");
+            static_assert(locality >= 0 && locality <= 3, "Bad locality");
+
+            template<typename Base>
+            using Iterator = PrefetchIterator<Base, distance, locality>;
+        };
+    }
+}
+
+#endif
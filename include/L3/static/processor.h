@@ -0,0 +1,394 @@
+#ifndef PROCESSOR_H
+#define PROCESSOR_H
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "barrier.h"
+#include "consume.h"
+#include "get.h"
+#include "spinpolicy.h"
+
+#include <atomic>
+#include <exception>
+#include <future>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#    include <pthread.h>
+#    include <sched.h>
+#endif
+
+namespace L3
+{
+    //
+    // Where a processor's thread runs. By default anywhere with
+    // normal scheduling. Given a cpu the thread is pinned to it and
+    // given a priority it runs SCHED_FIFO at that priority, which
+    // usually needs CAP_SYS_NICE.
+    //
+    struct ThreadOptions
+    {
+        static constexpr int anyCpu = -1;
+
+        ThreadOptions(int c = anyCpu, int p = 0): cpu(c), priority(p) {}
+
+        int cpu;
+        int priority;
+    };
+    //
+    // Owns a thread that runs until halted. Subclasses say what the
+    // thread does.
+    //
+    class Runner
+    {
+    public:
+        explicit Runner(ThreadOptions options): _options(options) {}
+        //
+        // Subclasses must stop() the thread in their destructor
+        // while what it's running still exists.
+        //
+        virtual ~Runner() = default;
+
+        Runner(const Runner&) = delete;
+        Runner& operator=(const Runner&) = delete;
+        //
+        // Start the thread. Returns once it's running. False if the
+        // thread couldn't be pinned or given the priority asked for,
+        // in which case it runs anyway where the scheduler puts it.
+        //
+        bool start()
+        {
+            if(_thread.joinable())
+            {
+                throw std::logic_error("Runner already started");
+            }
+            _alert.store(false, std::memory_order_relaxed);
+            //
+            // Shared so the promise outlives start() returning while
+            // set_value() is still finishing on the new thread.
+            //
+            auto placed = std::make_shared<std::promise<bool>>();
+            std::future<bool> result = placed->get_future();
+            _thread = std::thread(
+                [this, placed]
+                {
+                    placed->set_value(place(_options));
+                    try
+                    {
+                        run();
+                    }
+                    catch(...)
+                    {
+                        _error = std::current_exception();
+                    }
+                });
+            return result.get();
+        }
+        //
+        // Ask the thread to stop and wait for it. It stops once it has
+        // caught up with everything published so far so nothing
+        // already in a ring is lost. If the thread died with an
+        // exception it's rethrown here.
+        //
+        void halt()
+        {
+            stop();
+            if(_error)
+            {
+                std::exception_ptr error;
+                std::swap(error, _error);
+                std::rethrow_exception(error);
+            }
+        }
+
+        bool running() const { return _thread.joinable(); }
+
+    protected:
+        bool alerted() const { return _alert.load(std::memory_order_acquire); }
+
+        void stop()
+        {
+            if(!_thread.joinable())
+            {
+                return;
+            }
+            _alert.store(true, std::memory_order_release);
+            wake();
+            _thread.join();
+        }
+
+    private:
+        const ThreadOptions _options;
+        std::atomic<bool> _alert{false};
+        std::exception_ptr _error;
+        std::thread _thread;
+
+        virtual void run() = 0;
+        //
+        // Get the thread's attention if it might be parked.
+        //
+        virtual void wake() {}
+
+        static bool place(const ThreadOptions& options)
+        {
+            bool result = true;
+#ifdef __linux__
+            if(options.cpu != ThreadOptions::anyCpu)
+            {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(options.cpu, &set);
+                result &= pthread_setaffinity_np(
+                    pthread_self(), sizeof(set), &set) == 0;
+            }
+            if(options.priority)
+            {
+                sched_param param{};
+                param.sched_priority = options.priority;
+                result &= pthread_setschedparam(
+                    pthread_self(), SCHED_FIFO, &param) == 0;
+            }
+#else
+            result = options.cpu == ThreadOptions::anyCpu &&
+                !options.priority;
+#endif
+            return result;
+        }
+    };
+    //
+    // What an EventProcessor runs. A source has
+    //
+    //   size_t poll():      handle whatever's available now and
+    //                       return how many messages that was.
+    //   void idle(Policy&): wait a little for more using a spin
+    //                       policy.
+    //   void wake():        wake a thread that's idle.
+    //
+    namespace Source
+    {
+        //
+        // Batches from a Get handed to a handler in whichever way
+        // it takes them, see handle(). Idle processors wait on the
+        // Get's barrier so SpinPolicy::Block parks on the cursor it's
+        // behind.
+        //
+        // The whole batch is released even if the handler throws
+        // part way through, so messages after the one it threw on
+        // are never handed over. The processor stops and halt()
+        // rethrows.
+        //
+        template<typename Get, typename Handler> class Batches;
+
+        template<typename Disruptor,
+                 typename Tag,
+                 typename Barrier,
+                 typename SpinPolicy,
+                 typename PrefetchPolicy,
+                 typename PublishPolicy,
+                 typename Handler>
+        class Batches<
+            L3::Get<Disruptor,
+                    Tag,
+                    Barrier,
+                    SpinPolicy,
+                    PrefetchPolicy,
+                    PublishPolicy>,
+            Handler>
+        {
+        public:
+            using Get = L3::Get<Disruptor,
+                                Tag,
+                                Barrier,
+                                SpinPolicy,
+                                PrefetchPolicy,
+                                PublishPolicy>;
+
+            Batches(Handler handler): _handler(std::move(handler)) {}
+
+            size_t poll()
+            {
+                Get batch(Get::noBlock);
+                handle(_handler, batch);
+                return std::distance(batch.begin(), batch.end());
+            }
+
+            template<typename IdlePolicy>
+            void idle(IdlePolicy& ip)
+            {
+                spin<Barrier>(ip, Barrier::least());
+            }
+
+            void wake() { Barrier::notify(); }
+
+        private:
+            Handler _handler;
+        };
+        //
+        // A Selector polling several Gets with their handlers.
+        //
+        template<typename Selector>
+        struct Select
+        {
+            size_t poll() { return Selector::select(); }
+
+            template<typename IdlePolicy>
+            void idle(IdlePolicy& ip) { ip(); }
+
+            void wake() {}
+        };
+    }
+    //
+    // Run a source on its own thread. When there's nothing to do
+    // the thread idles using IdlePolicy, which is any spin policy. A
+    // new one is made each time the processor goes idle. Halting
+    // needs no end of stream message in the data. Instead the thread
+    // is alerted and stops the next time it finds nothing to do.
+    //
+    template<typename Input, typename IdlePolicy=SpinPolicy::Block<>>
+    class EventProcessor: public Runner
+    {
+    public:
+        explicit EventProcessor(Input input = Input(),
+                                ThreadOptions options = ThreadOptions()):
+            Runner(options),
+            _input(std::move(input))
+        {}
+
+        ~EventProcessor() { stop(); }
+
+    private:
+        Input _input;
+
+        void run() override
+        {
+            for(;;)
+            {
+                IdlePolicy ip;
+                while(!_input.poll())
+                {
+                    if(alerted())
+                    {
+                        //
+                        // The alert was stored after anything we
+                        // must catch up with was published but we
+                        // may have polled before seeing it.
+                        //
+                        while(_input.poll())
+                        {
+                        }
+                        return;
+                    }
+                    _input.idle(ip);
+                }
+            }
+        }
+
+        void wake() override { _input.wake(); }
+    };
+    //
+    // A processor handing each message from Get to handler, eg
+    //
+    //     auto c = L3::makeProcessor<Get>([](Msg m){ ... });
+    //     c->start();
+    //
+    template<typename Get,
+             typename IdlePolicy=SpinPolicy::Block<>,
+             typename Handler>
+    std::unique_ptr<Runner> makeProcessor(
+        Handler handler,
+        ThreadOptions options = ThreadOptions())
+    {
+        using Input = Source::Batches<Get, Handler>;
+        return std::unique_ptr<Runner>(
+            new EventProcessor<Input, IdlePolicy>(
+                Input(std::move(handler)), options));
+    }
+    //
+    // Processors for a whole topology. They're added upstream first,
+    // so a stage is added after every stage it follows. Starting goes
+    // from the last added back so every consumer is running before
+    // anything upstream of it publishes. Halting goes from the first
+    // added so each stage has caught up with everything upstream of
+    // it before it's halted. Anything outside the group publishing
+    // into it should have finished before the group is halted.
+    //
+    class Group
+    {
+    public:
+        Group& add(Runner& runner)
+        {
+            _runners.push_back(&runner);
+            return *this;
+        }
+        //
+        // False if any thread couldn't be placed as asked.
+        //
+        bool start()
+        {
+            bool result = true;
+            for(auto r = _runners.rbegin(); r != _runners.rend(); ++r)
+            {
+                result &= (*r)->start();
+            }
+            return result;
+        }
+        //
+        // Halts everything even if a processor died with an
+        // exception. The first such exception is rethrown once
+        // they've all stopped.
+        //
+        void halt()
+        {
+            std::exception_ptr error;
+            for(auto r: _runners)
+            {
+                try
+                {
+                    r->halt();
+                }
+                catch(...)
+                {
+                    if(!error)
+                    {
+                        error = std::current_exception();
+                    }
+                }
+            }
+            if(error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+
+    private:
+        std::vector<Runner*> _runners;
+    };
+}
+
+#endif
@@ -24,27 +24,41 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include "barrier.h"
 #include "sequence.h"
-//#include "barrier.h"
+#include "spinpolicy.h"
 
 #include <L3/util/cacheline.h>
 #include <L3/util/ring.h>
 
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <utility>
+
 namespace L3
 {
     namespace CommitPolicy
     {
+        //
+        // Make slots [slot, slot + n) visible to consumers. Only
+        // called once the claim has succeeded.
+        //
         struct Unique
         {
-            template<typename Cursor>
-            bool operator()(Cursor&, Index) { return false; }
+            template<typename Disruptor, typename SpinPolicy>
+            static void commit(Index slot, size_t n)
+            {
+                Disruptor::cursor.store(slot + n, std::memory_order_release);
+                Disruptor::cursor.notify();
+            }
             static constexpr std::memory_order order{std::memory_order_relaxed};
         };
 
         struct Shared
         {
-            template<typename Cursor>
-            bool operator()(Cursor& commitCursor, Index slot)
+            template<typename Disruptor, typename SpinPolicy>
+            static void commit(Index slot, size_t n)
             {
                 //
                 // For multiple producers it's possible that we've
@@ -53,7 +67,20 @@ namespace L3
                 // then we must wait for them. When cursor is 1 less
                 // than _slot we know that we are next to commit.
                 //
-                return commitCursor.load(std::memory_order_acquire) < slot;
+                SpinPolicy sp;
+                Index seen;
+                while((seen = Disruptor::cursor.load(std::memory_order_acquire))
+                      < slot)
+                {
+                    spin<Barrier<Disruptor>>(sp, seen);
+                }
+                //
+                // No need to CAS. Only we could have been waiting for
+                // this particular cursor value so it must now be
+                // slot. Publish all n slots with a single store.
+                //
+                Disruptor::cursor.store(slot + n, std::memory_order_release);
+                Disruptor::cursor.notify();
             }
             static constexpr std::memory_order order{std::memory_order_consume};
         };
@@ -67,33 +94,155 @@ namespace L3
         typename CommitSpinPolicy=NoOp>
     struct Put
     {
+        using Msg = typename Disruptor::Msg;
+
         Put(): _slot(claim()) {}
-        ~Put() { commit(_slot); }
+        //
+        // Non blocking and deadline bounded puts. If there's no room
+        // in the ring the claim fails without using up a sequence
+        // number and the put is false. Nothing is committed for a
+        // failed put and it must not be written to.
+        //
+        enum NoBlock { noBlock };
+        Put(NoBlock): _slot(claimIfRoom()) {}
 
-        template<typename T>
-        Put& operator=(const T& rhs) { *_slot = rhs; return *this; }
+        template<typename Clock, typename Duration>
+        Put(const std::chrono::time_point<Clock, Duration>& deadline):
+            _slot(claimIfRoom([&]{ return Clock::now() >= deadline; }))
+        {}
+        //
+        // As Put(noBlock), eg
+        //
+        //     if(auto p = Put::tryClaim()) { p = msg; }
+        //
+        static Put tryClaim() { return Put(noBlock); }
+        //
+        // Only the last owner of a claimed slot commits it.
+        //
+        Put(Put&& rhs): _slot(rhs._slot) { rhs._slot = Iterator(0); }
+
+        Put(const Put&) = delete;
+        Put& operator=(const Put&) = delete;
+
+        ~Put()
+        {
+            if(*this)
+            {
+                commit(_slot);
+            }
+        }
+        //
+        // Valid sequence numbers start at Disruptor::size so 0 can
+        // mean no slot claimed.
+        //
+        explicit operator bool() const { return Index(_slot) != 0; }
 
         template<typename T>
-        Put& operator=(const T&& rhs) { *_slot = rhs; return *this; }
+        Put& operator=(T&& rhs)
+        {
+            *_slot = std::forward<T>(rhs);
+            return *this;
+        }
+
+    private:
+        using Iterator = typename Disruptor::Iterator;
+        using Reference = typename std::iterator_traits<Iterator>::reference;
+        using Pointer = typename std::iterator_traits<Iterator>::pointer;
+
+    public:
+        //
+        // Direct access to the object already in the slot. Rather than
+        // assigning a new message a producer can write into the old
+        // one reusing any memory it owns. For example
+        //
+        //     Put p;
+        //     p->assign(buf, len);
+        //
+        // reuses the capacity of a std::string so once the ring has
+        // been round once there are no more allocations.
+        //
+        Reference operator*() const { return *_slot; }
+        Pointer operator->() const { return &*_slot; }
+        //
+        // Build a new message from args and move it into the slot.
+        //
+        template<typename... Args>
+        Put& emplace(Args&&... args)
+        {
+            *_slot = Msg(std::forward<Args>(args)...);
+            return *this;
+        }
 
         L3_CACHE_LINE static L3::Sequence cursor;
 
     private:
-        using Iterator = typename Disruptor::Iterator;
-        const Iterator _slot;
+        Iterator _slot;
 
+    public:
         //
-        // Claim 1 slot and block if we can't.
+        // Claim n contiguous slots in one go and commit them all when
+        // the batch goes out of scope. Costs the same number of
+        // atomic operations as a single Put however many slots are
+        // claimed. As with Put, once claimed every slot in the batch
+        // will be committed so all of them should be written.
         //
-        Index claim()
+        // The batch must fit in the ring - n must not be more than
+        // Disruptor::size - otherwise we'll wait forever for
+        // consumers to make room.
+        //
+        class Batch
+        {
+        public:
+            using Iterator = typename Put::Iterator;
+
+            Batch(size_t n): _begin(claim(n)), _end(Index(_begin) + n) {}
+            //
+            // Bulk copy [first, last) into the ring. Copies at most
+            // two contiguous runs so for trivially copyable messages
+            // in a packed ring this is one or two memcpys.
+            //
+            template<typename T>
+            Batch(const T* first, const T* last): Batch(last - first)
+            {
+                for(auto& span: spans(*this))
+                {
+                    std::copy(first, first + span.size(), span.begin());
+                    first += span.size();
+                }
+            }
+
+            ~Batch() { commit(_begin, Index(_end) - Index(_begin)); }
+
+            Iterator begin() const { return _begin; }
+            Iterator end() const { return _end; }
+            size_t size() const { return Index(_end) - Index(_begin); }
+
+        private:
+            const Iterator _begin;
+            const Iterator _end;
+        };
+
+    private:
+        using Cache = CachedBarrier<Barrier, Put>;
+
+        static bool hasRoom(Index slot)
+        {
+            Index least = Barrier::least();
+            Cache::update(least);
+            return least > slot - Disruptor::size;
+        }
+        //
+        // Claim n slots and block if we can't.
+        //
+        static Index claim(size_t n = 1)
         {
             //
-            // Claim a slot. Memory order depends on whether producer
-            // is shared.
+            // Claim our slots. Memory order depends on whether
+            // producer is shared.
             //
-            Index slot = cursor.fetch_add(1, CommitPolicy::order);
+            Index slot = cursor.fetch_add(n, CommitPolicy::order);
             //
-            // We have our slot but we cannot write to it until we
+            // We have our slots but we cannot write to them until we
             // are sure we will not overwrite data that has not
             // yet been consumed. In other words _head cannot lap
             // _tail around the ring.
@@ -104,59 +253,82 @@ namespace L3
             //
             //     _tail > _head - size
             //
-            // We spin while this is not the case.
+            // We spin while this is not the case. For a batch _head
+            // is the last slot we've claimed.
             //
             // To optimise the loop condition precompute _head -
             // size. To ensure that this difference is always positive
             // initialises _head and _tail using size as a baseline -
             // ie as if we have already done one lap around the ring.
             //
-            Index wrapAt = slot - Disruptor::size;
+            Index wrapAt = slot + n - 1 - Disruptor::size;
             //
             // We only need to know that this relation is satisfied at
             // this point. Since _tail monotonically increases the
-            // condition cannot be invalidated by consumers.
+            // condition cannot be invalidated by consumers. For the
+            // same reason if it held last time we looked it still
+            // does and we needn't read the consumers' cursors again.
             //
-            ClaimSpinPolicy sp;
-            while(Barrier::least() <= wrapAt)
+            if(Cache::least() <= wrapAt)
             {
-                sp();
+                ClaimSpinPolicy sp;
+                Index least;
+                while((least = Barrier::least()) <= wrapAt)
+                {
+                    spin<Barrier>(sp, least);
+                }
+                Cache::update(least);
             }
             return slot;
         }
 
+        static Index claimIfRoom()
+        {
+            return claimIfRoom([]{ return true; });
+        }
         //
-        // Claim up to batchSize. Don't block. Only works for unique
-        // producer.
+        // Claim 1 slot only if there's room for it. Unlike claim() we
+        // can't fetch_add the cursor up front as the slot could then
+        // never be given back. Instead check there's room for the
+        // next slot and CAS the cursor past it. If another producer
+        // got there first the CAS gives us the new next slot and we
+        // try again. Spin while the ring is full until expired()
+        // says to give up.
         //
-        Index claim(size_t batchSize)
+        template<typename Expired>
+        static Index claimIfRoom(Expired expired)
         {
-            Index begin = cursor.load(std::memory_order_relaxed);
-            Index end = std::min(begin + batchSize, Barrier::least() - 1);
-
-            cursor.store(end, std::memory_order_relaxed);                
+            Index slot = cursor.load(std::memory_order_relaxed);
+            ClaimSpinPolicy sp;
+            for(;;)
+            {
+                if(Cache::least() > slot - Disruptor::size ||
+                   hasRoom(slot))
+                {
+                    if(cursor.compare_exchange_weak(
+                           slot,
+                           slot + 1,
+                           CommitPolicy::order,
+                           std::memory_order_relaxed))
+                    {
+                        return slot;
+                    }
+                }
+                else if(expired())
+                {
+                    return 0;
+                }
+                else
+                {
+                    spin<Barrier>(sp, Cache::least());
+                }
+            }
         }
 
-        void commit(Index slot)
+        static void commit(Index slot, size_t n = 1)
         {
-            //
-            // For multiple producers it's possible that we've claimed a
-            // slot while another producer is doing a put. If the other
-            // producers have not yet committed then we must wait for
-            // them. When cursor is 1 less than _slot we know that we are
-            // next to commit.
-            //
-            CommitSpinPolicy sp;
-            CommitPolicy shouldSpin;
-            while(shouldSpin(Disruptor::cursor, slot))
-            {
-                sp();
-            }
-            //
-            // No need to CAS. Only we could have been waiting for
-            // this particular cursor value.
-            //
-            Disruptor::cursor.fetch_add(1, std::memory_order_release);
+            CommitPolicy::template commit<Disruptor, CommitSpinPolicy>(
+                slot, n);
         }
     };
 
@@ -171,6 +343,20 @@ namespace L3
         CommitPolicy,
         ClaimSpinPolicy,
         CommitSpinPolicy>::cursor{Disruptor::size};
+
+    namespace detail
+    {
+        //
+        // Size of the ring a Put publishes to.
+        //
+        template<typename Put> struct RingSize;
+
+        template<typename Disruptor, typename... Policies>
+        struct RingSize<Put<Disruptor, Policies...>>
+        {
+            static constexpr size_t value = Disruptor::size;
+        };
+    }
 }
 
 #endif
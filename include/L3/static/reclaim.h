@@ -0,0 +1,112 @@
+#ifndef RECLAIM_H
+#define RECLAIM_H
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "get.h"
+
+#include <L3/util/types.h>
+
+#include <atomic>
+
+namespace L3
+{
+    namespace ReclaimPolicy
+    {
+        //
+        // Replace the message with a default constructed one freeing
+        // anything it owned.
+        //
+        struct Destroy
+        {
+            template<typename T>
+            void operator()(T& msg) const { msg = T(); }
+        };
+        //
+        // Empty the message but keep hold of its memory for the next
+        // producer to reuse.
+        //
+        struct Clear
+        {
+            template<typename T>
+            void operator()(T& msg) const { msg.clear(); }
+        };
+    }
+    //
+    // Slots hold on to their messages until a producer overwrites
+    // them a lap later. For messages that own memory that means the
+    // producer pays to free whatever was there before.
+    //
+    // A Reclaimer is a consumer that follows all the other consumers
+    // and resets the slots they've finished with. Gate producers on
+    // the Reclaimer rather than the consumers and they'll only ever
+    // see reset slots. The cost of destruction is moved to whichever
+    // thread calls reclaim().
+    //
+    //     using D = L3::Disruptor<std::string, 14>;
+    //     using Get = D::Get<>;
+    //     using Reclaim = L3::Reclaimer<D, L3::Barrier<Get>>;
+    //     using Put = D::Put<L3::Barrier<Reclaim::Get>>;
+    //
+    template<typename Disruptor,
+             typename Barrier,
+             typename Reset=ReclaimPolicy::Destroy>
+    struct Reclaimer
+    {
+        struct Tag {};
+        using Get = typename Disruptor::template Get<Tag, Barrier>;
+        using Msg = typename Disruptor::Msg;
+        //
+        // Reset the slots of one batch, if there is one, without
+        // blocking. Returns the number of slots reset.
+        //
+        static size_t reclaim(size_t maxBatchSize = Disruptor::size)
+        {
+            Reset reset;
+            Get g(maxBatchSize, Get::noBlock);
+            for(Msg& msg: g)
+            {
+                reset(msg);
+            }
+            return Index(g.end()) - Index(g.begin());
+        }
+        //
+        // Reclaim until told to stop.
+        //
+        template<typename SpinPolicy=NoOp>
+        static void run(const std::atomic<bool>& running)
+        {
+            SpinPolicy sp;
+            while(running.load(std::memory_order_relaxed))
+            {
+                if(!reclaim())
+                {
+                    sp();
+                }
+            }
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef REPLICATOR_H
+#define REPLICATOR_H
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "put.h"
+
+#include <L3/util/numa.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+
+namespace L3
+{
+    //
+    // Copy everything published to one disruptor into another. On a
+    // multi socket machine consumers on the far socket from a ring
+    // pay for remote memory on every Get and drag its cache lines
+    // back and forth across the interconnect. Instead a replicator
+    // running on their node takes each batch off the source in one
+    // go and republishes it into a ring placed on that node, which
+    // they then consume locally. Something like
+    //
+    //     using Local = Disruptor<Msg, 16, Tag<2>>;
+    //     using Copy = Replicator<Source::Get<Tag<2>>, Local::Put<>>;
+    //
+    //     L3::warm<Local>(options, remote);
+    //     auto eos = [](const Msg& m) { return m.last; };
+    //     std::thread t([&]{ Numa::runOn(remote); Copy::run(eos); });
+    //
+    // The source Get is one more consumer of the source ring, so the
+    // source producer should gate on it, and the local Put gates on
+    // the local consumers as usual. Batches are capped at
+    // maxBatchSize, which must be no bigger than the local ring.
+    //
+    template<typename Get, typename Put, size_t maxBatchSize = 256>
+    struct Replicator
+    {
+        static_assert(maxBatchSize > 0, "Empty batch");
+        static_assert(maxBatchSize <= detail::RingSize<Put>::value,
+                      "Batch larger than ring");
+        //
+        // Copy whatever is available now. Returns how many messages
+        // were copied.
+        //
+        static size_t poll()
+        {
+            Get g(maxBatchSize, Get::noBlock);
+            return copy(g);
+        }
+        //
+        // Wait for at least one message, as the Get's spin policy
+        // says, then copy it and anything else available.
+        //
+        static size_t replicate()
+        {
+            Get g(maxBatchSize);
+            return copy(g);
+        }
+        //
+        // Replicate until done() is true after a batch. done() sees
+        // each message copied so can look for an end of stream
+        // marker.
+        //
+        template<typename Done>
+        static void run(Done done)
+        {
+            for(;;)
+            {
+                Get g(maxBatchSize);
+                copy(g);
+                for(auto& msg: g)
+                {
+                    if(done(msg))
+                    {
+                        return;
+                    }
+                }
+            }
+        }
+
+    private:
+        static size_t copy(const Get& g)
+        {
+            size_t n = std::distance(g.begin(), g.end());
+            if(n)
+            {
+                typename Put::Batch b(n);
+                std::copy(g.begin(), g.end(), b.begin());
+            }
+            return n;
+        }
+    };
+}
+
+#endif
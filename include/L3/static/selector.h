@@ -1,25 +1,35 @@
 #ifndef SELECTOR_H
 #define SELECTOR_H
 
+#include "consume.h"
+
+#include <cstddef>
+#include <iterator>
+
 namespace L3
 {
+    //
+    // Poll each Get in turn, handing whatever's available to its
+    // handler in whichever way it takes it, see handle(). Returns the
+    // number of messages handled so callers can tell when there was
+    // nothing to do.
+    //
     template<typename...>
     struct Selector
     {
-        static void select() {}
+        static size_t select() { return 0; }
     };
 
     template<typename Get, typename F, typename... Tail>
     struct Selector<Get, F, Tail...>: Selector<Tail...>
     {
-        static void select()
+        static size_t select()
         {
             F f;
-            for(auto& m: Get(Get::noBlock))
-            {
-                f(m);
-            }
-            Selector<Tail...>::select();            
+            Get batch(Get::noBlock);
+            handle(f, batch);
+            return std::distance(batch.begin(), batch.end()) +
+                Selector<Tail...>::select();
         }
     };
 
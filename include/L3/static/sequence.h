@@ -24,6 +24,7 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+#include <L3/util/futex.h>
 #include <L3/util/types.h>
 
 #include <atomic>
@@ -32,27 +33,45 @@ SOFTWARE.
 
 namespace L3
 {
-    template<typename, typename, typename, typename> struct Get;
+    template<typename, typename, typename, typename, typename, typename>
+    struct Get;
     template<typename, typename, typename, typename, typename> struct Put;
     template<typename...> struct Barrier;
+    template<typename...> struct WideBarrier;
 
-    namespace CommitPolicy { struct Shared; }
+    namespace CommitPolicy { struct Unique; struct Shared; }
     
     class Sequence: std::atomic<Index>
     {
-        template<typename, typename, typename, typename>
+        template<typename, typename, typename, typename, typename, typename>
         friend struct Get;
         template<typename, typename, typename, typename, typename>
         friend struct Put;
         template<typename...>
         friend struct Barrier;
+        template<typename...>
+        friend struct WideBarrier;
 
+        friend struct CommitPolicy::Unique;
         friend struct CommitPolicy::Shared;
 
     public:
         using std::atomic<Index>::operator Index;        
         Sequence(): std::atomic<Index>{} {}
         Sequence(Index i): std::atomic<Index>{i} {}
+        //
+        // Park until the sequence moves on from seen, or for at most
+        // timeout. Whoever moves the sequence must call notify().
+        //
+        void wait(Index seen, std::chrono::nanoseconds timeout) const
+        {
+            _waiters.wait(*this, seen, timeout);
+        }
+
+        void notify() const { _waiters.notify(*this); }
+
+    private:
+        Futex::Waiters _waiters;
     };
 
 }
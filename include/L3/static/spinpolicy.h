@@ -1,10 +1,27 @@
 #ifndef SPINPOLICY_H
 #define SPINPOLICY_H
 
+#include <L3/util/types.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <thread>
 
 namespace L3
 {
+    //
+    // Tell the CPU we're in a spin loop.
+    //
+    inline void pause()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
     namespace SpinPolicy
     {
         struct Yield
@@ -14,6 +31,180 @@ namespace L3
                 std::this_thread::yield();
             }
         };
+        //
+        // Spin for a while then park on the futex of whichever
+        // cursor we're waiting for. The publisher only makes a
+        // system call to wake us if someone's parked so disruptors
+        // that are mostly idle don't each need a core. While parked
+        // we wake at least every parkMicros to look again.
+        //
+        // Where there's no cursor to park on we yield.
+        //
+        template<size_t spins=1000, size_t parkMicros=1000>
+        struct Block
+        {
+            void operator()()
+            {
+                if(_spins < spins)
+                {
+                    ++_spins;
+                    pause();
+                }
+                else
+                {
+                    std::this_thread::yield();
+                }
+            }
+
+            template<typename Barrier>
+            void wait(Index seen)
+            {
+                if(_spins < spins)
+                {
+                    ++_spins;
+                    pause();
+                }
+                else
+                {
+                    Barrier::wait(seen, std::chrono::microseconds(parkMicros));
+                }
+            }
+
+            size_t _spins{0};
+        };
+        //
+        // Busy spin, then back off exponentially, then yield, then
+        // sleep. How long we busy spin adapts to how long recent
+        // waits were. If they were short enough to end while we were
+        // still spinning or backing off we aim to spin for twice as
+        // long as they took. If they went on to yield or sleep
+        // spinning didn't help so we spin less next time. That way
+        // stages that usually have work close at hand spin and ones
+        // that sit idle sleep without hand tuning.
+        //
+        // There is one estimate for each Barrier waited on. A Tag can
+        // be used to keep estimates apart where different stages wait
+        // on the same barrier. Estimates are shared by all threads
+        // waiting on the barrier.
+        //
+        template<size_t minSpins=16,
+                 size_t maxSpins=4096,
+                 size_t backoffs=6,
+                 size_t yields=16,
+                 size_t sleepMicros=50,
+                 typename Tag=void>
+        class Phased
+        {
+        public:
+            static_assert(minSpins <= maxSpins, "Bad spin limits");
+
+            Phased() = default;
+            Phased(const Phased&) = delete;
+            Phased& operator=(const Phased&) = delete;
+
+            ~Phased()
+            {
+                if(!_estimate)
+                {
+                    return;
+                }
+                long target = _n < _spins + backoffs
+                    ? std::min(std::max(2 * _pauses, minSpins), maxSpins)
+                    : minSpins;
+                long estimate = _estimate->load(std::memory_order_relaxed);
+                _estimate->store(
+                    estimate + (target - estimate) / 8,
+                    std::memory_order_relaxed);
+            }
+
+            void operator()() { step<void>(); }
+
+            template<typename Barrier>
+            void wait(Index) { step<Barrier>(); }
+
+        private:
+            template<typename Barrier>
+            struct Estimate
+            {
+                static std::atomic<size_t> spins;
+            };
+
+            template<typename Barrier>
+            void step()
+            {
+                if(!_estimate)
+                {
+                    _estimate = &Estimate<Barrier>::spins;
+                    _spins = _estimate->load(std::memory_order_relaxed);
+                }
+
+                if(_n < _spins)
+                {
+                    pause();
+                    ++_pauses;
+                }
+                else if(_n < _spins + backoffs)
+                {
+                    for(size_t i = size_t(1) << (_n - _spins); i; --i)
+                    {
+                        pause();
+                        ++_pauses;
+                    }
+                }
+                else if(_n < _spins + backoffs + yields)
+                {
+                    std::this_thread::yield();
+                }
+                else
+                {
+                    std::this_thread::sleep_for(
+                        std::chrono::microseconds(sleepMicros));
+                }
+                ++_n;
+            }
+
+            std::atomic<size_t>* _estimate{nullptr};
+            size_t _spins{0};
+            size_t _n{0};
+            size_t _pauses{0};
+        };
+
+        template<size_t minSpins,
+                 size_t maxSpins,
+                 size_t backoffs,
+                 size_t yields,
+                 size_t sleepMicros,
+                 typename Tag>
+        template<typename Barrier>
+        std::atomic<size_t>
+        Phased<minSpins, maxSpins, backoffs, yields, sleepMicros, Tag>::
+        Estimate<Barrier>::spins{minSpins};
+    }
+
+    namespace detail
+    {
+        template<typename Barrier, typename SpinPolicy>
+        auto spin(SpinPolicy& sp, Index seen, int)
+            -> decltype(sp.template wait<Barrier>(seen))
+        {
+            return sp.template wait<Barrier>(seen);
+        }
+
+        template<typename Barrier, typename SpinPolicy>
+        void spin(SpinPolicy& sp, Index, long)
+        {
+            sp();
+        }
+    }
+    //
+    // Called from loops waiting for Barrier to move past seen. Spin
+    // policies that can block are told what they're waiting for, the
+    // rest are just called.
+    //
+    template<typename Barrier, typename SpinPolicy>
+    void spin(SpinPolicy& sp, Index seen)
+    {
+        detail::spin<Barrier>(sp, seen, 0);
     }
 }
 
@@ -0,0 +1,65 @@
+#ifndef WARM_H
+#define WARM_H
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <L3/util/memory.h>
+
+namespace L3
+{
+    //
+    // Get the rings of static disruptors ready before they're needed,
+    // eg at startup for every disruptor in a topology
+    //
+    //     L3::warm<D1, D2, D3>();
+    //
+    // Otherwise the first lap round each ring takes a page fault per
+    // page. Static rings are in BSS so can't be remapped onto
+    // explicit huge pages. Memory::hugePages asks for transparent
+    // huge pages instead, which must happen before the pages are
+    // touched. Returns false if any ring couldn't be locked.
+    //
+    // Given a node the rings are put on that NUMA node before being
+    // touched. Rings read on another node can be replicated there,
+    // see Replicator.
+    //
+    template<typename... Ds>
+    bool warm(unsigned options =
+              Memory::hugePages | Memory::prefault | Memory::lock,
+              int node = Numa::anyNode)
+    {
+        bool result = true;
+        bool locked[] = {
+            true,
+            Memory::warm(&Ds::ring, sizeof(Ds::ring), options, node)...
+        };
+        for(bool l: locked)
+        {
+            result &= l;
+        }
+        return result;
+    }
+}
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <cstddef>
 #include <type_traits>
+#include <utility>
 
 #ifndef L3_CACHE_LINE_SIZE
 #    define L3_CACHE_LINE_SIZE 64
@@ -49,7 +50,7 @@ namespace L3 // Low Latency Library
 
         CacheLineImpl<T, false>& operator=(T&& rhs)
         {
-            value = rhs;
+            value = std::move(rhs);
             return *this;
         }
         
@@ -57,21 +58,29 @@ namespace L3 // Low Latency Library
         operator const T&() const { return value; }
     };
     
-    template<typename T>
-    struct L3_CACHE_LINE CacheLine: CacheLineImpl<T, std::is_class<T>::value>
+    //
+    // T aligned, and so padded, to a given boundary.
+    //
+    template<typename T, size_t alignment>
+    struct alignas(alignment) Aligned:
+        CacheLineImpl<T, std::is_class<T>::value>
     {
-        CacheLine& operator=(const T& rhs)
+        Aligned& operator=(const T& rhs)
         {
             CacheLineImpl<T, std::is_class<T>::value>::operator=(rhs);
             return *this;
         }
 
-        CacheLine& operator=(T&& rhs)
+        Aligned& operator=(T&& rhs)
         {
-            CacheLineImpl<T, std::is_class<T>::value>::operator=(rhs);
+            CacheLineImpl<T, std::is_class<T>::value>::operator=(
+                std::move(rhs));
             return *this;
         }
     };
+
+    template<typename T>
+    using CacheLine = Aligned<T, cache_line_size>;
 }
 
 
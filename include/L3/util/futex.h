@@ -0,0 +1,146 @@
+#ifndef FUTEX_H
+#define FUTEX_H
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "types.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+#ifdef __linux__
+#    include <linux/futex.h>
+#    include <sys/syscall.h>
+#    include <time.h>
+#    include <unistd.h>
+#endif
+
+namespace L3
+{
+    //
+    // Park a thread on a 64 bit counter until it changes. Futexes
+    // work on 32 bits so we use the low order half of the counter. As
+    // the counter only goes up that half must change whenever the
+    // counter does.
+    //
+    // Elsewhere we sleep for the timeout and rely on the caller
+    // looping.
+    //
+    namespace Futex
+    {
+        inline const uint32_t* lowWord(const std::atomic<Index>& word)
+        {
+            const uint32_t* p = reinterpret_cast<const uint32_t*>(&word);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            return p + 1;
+#else
+            return p;
+#endif
+        }
+        //
+        // Sleep while word is seen or until timeout. May return
+        // early.
+        //
+        inline void wait(const std::atomic<Index>& word,
+                         Index seen,
+                         std::chrono::nanoseconds timeout)
+        {
+#ifdef __linux__
+            using namespace std::chrono;
+            timespec ts;
+            ts.tv_sec = duration_cast<seconds>(timeout).count();
+            ts.tv_nsec = (timeout - seconds(ts.tv_sec)).count();
+            syscall(SYS_futex,
+                    lowWord(word),
+                    FUTEX_WAIT_PRIVATE,
+                    uint32_t(seen),
+                    &ts,
+                    nullptr,
+                    0);
+#else
+            (void)word;
+            (void)seen;
+            std::this_thread::sleep_for(timeout);
+#endif
+        }
+
+        inline void wakeAll(const std::atomic<Index>& word)
+        {
+#ifdef __linux__
+            syscall(SYS_futex,
+                    lowWord(word),
+                    FUTEX_WAKE_PRIVATE,
+                    INT32_MAX,
+                    nullptr,
+                    nullptr,
+                    0);
+#else
+            (void)word;
+#endif
+        }
+        //
+        // Count of threads parked on a word. Publishers check it
+        // after storing a new value so only pay for the system call
+        // when someone is actually waiting.
+        //
+        // There's no fence between the publisher's store and its
+        // load of the count so it can miss a waiter that has just
+        // arrived. The kernel compares the word with what the waiter
+        // saw before parking it, which closes most of that window,
+        // and waiters park with a timeout which closes the rest.
+        //
+        class Waiters
+        {
+        public:
+            constexpr Waiters(): _count{0} {}
+
+            void wait(const std::atomic<Index>& word,
+                      Index seen,
+                      std::chrono::nanoseconds timeout) const
+            {
+                _count.fetch_add(1, std::memory_order_seq_cst);
+                if(word.load(std::memory_order_seq_cst) == seen)
+                {
+                    Futex::wait(word, seen, timeout);
+                }
+                _count.fetch_sub(1, std::memory_order_relaxed);
+            }
+
+            void notify(const std::atomic<Index>& word) const
+            {
+                if(_count.load(std::memory_order_relaxed))
+                {
+                    wakeAll(word);
+                }
+            }
+
+        private:
+            mutable std::atomic<uint32_t> _count;
+        };
+    }
+}
+
+#endif
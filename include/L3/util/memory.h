@@ -0,0 +1,462 @@
+#ifndef MEMORY_H
+#define MEMORY_H
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "cacheline.h"
+#include "numa.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+
+namespace L3
+{
+    //
+    // A cache line aligned block of memory owned for the lifetime of
+    // the object. Either
+    //
+    //   heap:      from the heap.
+    //   anonymous: mapped privately. Page aligned and pages are only
+    //              backed when touched.
+    //   shared:    mapped anonymously but shared with any processes
+    //              forked after it's created.
+    //   named:     a POSIX shared memory object that other processes
+    //              can attach to by name. See create() and attach().
+    //
+    // New memory is zeroed.
+    //
+    // Options trade startup time and locked memory for avoiding page
+    // faults and TLB misses once running.
+    //
+    //   hugePages: 2MB pages. Mapped memory tries MAP_HUGETLB, which
+    //              needs pages reserved in
+    //              /proc/sys/vm/nr_hugepages, then falls back to
+    //              asking for transparent huge pages.
+    //   gigantic:  as hugePages but 1GB.
+    //   prefault:  touch every page now rather than on first use.
+    //   lock:      mlock so pages are never swapped out.
+    //
+    // Given a node the pages are placed on that NUMA node before
+    // they're touched. See Numa::bind.
+    //
+    class Memory
+    {
+    public:
+        enum Backing { heap, anonymous, shared, named };
+
+        enum Options
+        {
+            none = 0,
+            hugePages = 1 << 0,
+            gigantic = 1 << 1,
+            prefault = 1 << 2,
+            lock = 1 << 3
+        };
+
+        static constexpr size_t hugePageSize = size_t(2) << 20;
+        static constexpr size_t giganticPageSize = size_t(1) << 30;
+
+        Memory(size_t size,
+               Backing backing = heap,
+               unsigned options = none,
+               int node = Numa::anyNode):
+            _size(size),
+            _backing(backing),
+            _data(allocate(_size, backing, options, node))
+        {
+            _locked = warm(_data, _size, options);
+        }
+        //
+        // Make a new named object. Throws std::system_error with
+        // EEXIST if there's one already. The name is unlinked when
+        // the creator's Memory is destroyed.
+        //
+        static Memory create(const std::string& name,
+                             size_t size,
+                             unsigned options = none,
+                             int node = Numa::anyNode)
+        {
+            int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+            if(fd < 0)
+            {
+                throwError("shm_open " + name);
+            }
+            //
+            // Nobody else can have the name yet so don't leave it
+            // behind if we fail.
+            //
+            if(ftruncate(fd, size) < 0)
+            {
+                int error = errno;
+                close(fd);
+                shm_unlink(name.c_str());
+                errno = error;
+                throwError("ftruncate " + name);
+            }
+            void* data;
+            try
+            {
+                data = map(fd, size);
+            }
+            catch(...)
+            {
+                shm_unlink(name.c_str());
+                throw;
+            }
+            Memory result(name, size, data, true);
+            result._locked = warm(result._data, size, options, node);
+            return result;
+        }
+        //
+        // As create() but first unlink any object with the name, eg
+        // one left by a creator that died. Processes attached to it
+        // keep their mapping but are no longer connected to anyone
+        // attaching by name from now on, so only replace what's
+        // known to be stale.
+        //
+        static Memory replace(const std::string& name,
+                              size_t size,
+                              unsigned options = none,
+                              int node = Numa::anyNode)
+        {
+            shm_unlink(name.c_str());
+            return create(name, size, options, node);
+        }
+        //
+        // Map an object someone else has created.
+        //
+        static Memory attach(const std::string& name, unsigned options = none)
+        {
+            int fd = shm_open(name.c_str(), O_RDWR, 0);
+            if(fd < 0)
+            {
+                throwError("shm_open " + name);
+            }
+            struct stat st;
+            if(fstat(fd, &st) < 0)
+            {
+                close(fd);
+                throwError("fstat " + name);
+            }
+            size_t size = st.st_size;
+            Memory result(name, size, map(fd, size), false);
+            result._locked = warm(result._data, size, options,
+                                  Numa::anyNode, true);
+            return result;
+        }
+        //
+        // Apply prefault, lock and transparent huge page options to
+        // memory we didn't allocate, such as a static ring, placing
+        // it on node first. Returns false if asked to lock and we
+        // couldn't, usually because RLIMIT_MEMLOCK is too low.
+        //
+        // Without MADV_POPULATE_WRITE prefaulting writes each page
+        // back to itself, so warm memory before anyone uses it.
+        //
+        static bool warm(void* data,
+                         size_t size,
+                         unsigned options,
+                         int node = Numa::anyNode)
+        {
+            return warm(data, size, options, node, false);
+        }
+
+        Memory(Memory&& rhs):
+            _size(rhs._size),
+            _backing(rhs._backing),
+            _data(rhs._data),
+            _name(std::move(rhs._name)),
+            _owner(rhs._owner),
+            _locked(rhs._locked)
+        {
+            rhs._data = nullptr;
+            rhs._owner = false;
+        }
+
+        Memory(const Memory&) = delete;
+        Memory& operator=(const Memory&) = delete;
+        Memory& operator=(Memory&&) = delete;
+
+        ~Memory()
+        {
+            if(_owner)
+            {
+                shm_unlink(_name.c_str());
+            }
+            if(!_data)
+            {
+                return;
+            }
+            switch(_backing)
+            {
+            case heap:
+                free(_data);
+                break;
+            case anonymous:
+            case shared:
+            case named:
+                munmap(_data, _size);
+                break;
+            }
+        }
+
+        void* data() const { return _data; }
+        size_t size() const { return _size; }
+        Backing backing() const { return _backing; }
+        const std::string& name() const { return _name; }
+        //
+        // False if lock was asked for but failed.
+        //
+        bool locked() const { return _locked; }
+
+    private:
+        size_t _size;
+        Backing _backing;
+        void* _data;
+        std::string _name;
+        bool _owner{false};
+        bool _locked{true};
+        //
+        // Memory that's in use, eg by another process that created
+        // it, is only read if it can't be populated for writing
+        // without touching it. Pages are then mapped but writes may
+        // still fault.
+        //
+        static bool warm(void* data,
+                         size_t size,
+                         unsigned options,
+                         int node,
+                         bool inUse)
+        {
+            Numa::bind(data, size, node);
+            if(options & (hugePages | gigantic))
+            {
+                adviseHugePages(data, size);
+            }
+            if(options & prefault)
+            {
+                populate(data, size, inUse);
+            }
+            if(options & lock)
+            {
+                return mlock(data, size) == 0;
+            }
+            return true;
+        }
+
+        static void populate(void* data, size_t size, bool inUse)
+        {
+            const size_t pageSize = sysconf(_SC_PAGESIZE);
+#ifdef MADV_POPULATE_WRITE
+            //
+            // Faults pages in writable without changing them.
+            //
+            char* begin = reinterpret_cast<char*>(
+                reinterpret_cast<uintptr_t>(data) & ~(pageSize - 1));
+            if(madvise(begin,
+                       static_cast<char*>(data) + size - begin,
+                       MADV_POPULATE_WRITE) == 0)
+            {
+                return;
+            }
+#endif
+            volatile char* p = static_cast<volatile char*>(data);
+            for(size_t i = 0; i < size; i += pageSize)
+            {
+                if(inUse)
+                {
+                    (void)p[i];
+                }
+                else
+                {
+                    p[i] = p[i];
+                }
+            }
+        }
+
+        static void adviseHugePages(void* data, size_t size)
+        {
+#ifdef MADV_HUGEPAGE
+            //
+            // madvise wants a page aligned start.
+            //
+            const size_t pageSize = sysconf(_SC_PAGESIZE);
+            char* begin = reinterpret_cast<char*>(
+                (reinterpret_cast<uintptr_t>(data) + pageSize - 1) &
+                ~(pageSize - 1));
+            char* end = static_cast<char*>(data) + size;
+            if(begin < end)
+            {
+                madvise(begin, end - begin, MADV_HUGEPAGE);
+            }
+#else
+            (void)data;
+            (void)size;
+#endif
+        }
+
+        Memory(const std::string& name, size_t size, void* data, bool owner):
+            _size(size),
+            _backing(named),
+            _data(data),
+            _name(name),
+            _owner(owner)
+        {}
+
+        static void throwError(const std::string& what)
+        {
+            throw std::system_error(errno, std::system_category(), what);
+        }
+
+        static void* map(int fd, size_t size)
+        {
+            void* result = mmap(nullptr,
+                                size,
+                                PROT_READ | PROT_WRITE,
+                                MAP_SHARED,
+                                fd,
+                                0);
+            int error = errno;
+            close(fd);
+            if(result == MAP_FAILED)
+            {
+                errno = error;
+                throwError("mmap");
+            }
+            return result;
+        }
+
+        static size_t roundUp(size_t size, size_t to)
+        {
+            return (size + to - 1) / to * to;
+        }
+        //
+        // Explicit huge pages. Size is rounded up to a whole number
+        // of them.
+        //
+        static void* mapHuge(size_t& size, int flags, unsigned options)
+        {
+#ifdef MAP_HUGETLB
+            size_t pageSize = hugePageSize;
+            flags |= MAP_HUGETLB;
+            if(options & gigantic)
+            {
+                pageSize = giganticPageSize;
+#    ifdef MAP_HUGE_SHIFT
+                flags |= 30 << MAP_HUGE_SHIFT;
+#    endif
+            }
+            size_t rounded = roundUp(size, pageSize);
+            void* result = mmap(nullptr,
+                                rounded,
+                                PROT_READ | PROT_WRITE,
+                                flags,
+                                -1,
+                                0);
+            if(result != MAP_FAILED)
+            {
+                size = rounded;
+                return result;
+            }
+#else
+            (void)size;
+            (void)flags;
+            (void)options;
+#endif
+            return nullptr;
+        }
+
+        static void* allocate(size_t& size,
+                              Backing backing,
+                              unsigned options,
+                              int node)
+        {
+            void* result = nullptr;
+            switch(backing)
+            {
+            case heap:
+                if(posix_memalign(&result,
+                                  options & (hugePages | gigantic)
+                                  ? hugePageSize : cache_line_size,
+                                  size))
+                {
+                    throw std::bad_alloc();
+                }
+                Numa::bind(result, size, node);
+                //
+                // Advise before zeroing or the pages are already
+                // faulted in small.
+                //
+                if(options & (hugePages | gigantic))
+                {
+                    adviseHugePages(result, size);
+                }
+                memset(result, 0, size);
+                break;
+            case anonymous:
+            case shared:
+            {
+                int flags = (backing == shared ? MAP_SHARED : MAP_PRIVATE) |
+                    MAP_ANONYMOUS;
+                if(options & (hugePages | gigantic))
+                {
+                    result = mapHuge(size, flags, options);
+                }
+                if(!result)
+                {
+                    result = mmap(nullptr,
+                                  size,
+                                  PROT_READ | PROT_WRITE,
+                                  flags,
+                                  -1,
+                                  0);
+                    if(result == MAP_FAILED)
+                    {
+                        throw std::bad_alloc();
+                    }
+                }
+                Numa::bind(result, size, node);
+                break;
+            }
+            case named:
+                throw std::invalid_argument("Use Memory::create for named");
+            }
+            return result;
+        }
+    };
+}
+
+#endif
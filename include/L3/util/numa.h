@@ -0,0 +1,300 @@
+#ifndef NUMA_H
+#define NUMA_H
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#    include <sched.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+namespace L3
+{
+    //
+    // Just enough NUMA to put a ring's pages on the node its
+    // consumers run on. Topology comes from sysfs and placement uses
+    // the mbind and set_mempolicy system calls directly so there's no
+    // dependency on libnuma.
+    //
+    // Everything degrades to a no-op on a single node, on kernels
+    // without NUMA support and off Linux. Placement is a hint for
+    // performance so failing to place memory isn't an error - the
+    // memory is still usable wherever it ends up.
+    //
+    namespace Numa
+    {
+        constexpr int anyNode = -1;
+        //
+        // Parse a sysfs list such as "0-3,8,10-11".
+        //
+        inline std::vector<int> parseList(const std::string& list)
+        {
+            std::vector<int> result;
+            size_t pos = 0;
+            while(pos < list.size())
+            {
+                size_t next;
+                int first = std::stoi(list.substr(pos), &next);
+                int last = first;
+                pos += next;
+                if(pos < list.size() && list[pos] == '-')
+                {
+                    last = std::stoi(list.substr(++pos), &next);
+                    pos += next;
+                }
+                for(int i = first; i <= last; ++i)
+                {
+                    result.push_back(i);
+                }
+                pos = list.find(',', pos);
+                if(pos == std::string::npos)
+                {
+                    break;
+                }
+                ++pos;
+            }
+            return result;
+        }
+
+        inline std::vector<int> readList(const std::string& path)
+        {
+            std::ifstream is(path);
+            std::string list;
+            if(!std::getline(is, list) || list.empty())
+            {
+                return std::vector<int>();
+            }
+            return parseList(list);
+        }
+        //
+        // Number of nodes, counting from 0. At least 1.
+        //
+        inline int nodes()
+        {
+            std::vector<int> online =
+                readList("/sys/devices/system/node/online");
+            return online.empty() ? 1 : online.back() + 1;
+        }
+        //
+        // CPUs on node. Empty if the node doesn't exist.
+        //
+        inline std::vector<int> cpus(int node)
+        {
+            return readList("/sys/devices/system/node/node" +
+                            std::to_string(node) + "/cpulist");
+        }
+        //
+        // Node cpu is on. 0 if we can't tell.
+        //
+        inline int nodeOf(int cpu)
+        {
+            for(int node = 0, n = nodes(); node < n; ++node)
+            {
+                for(int c: cpus(node))
+                {
+                    if(c == cpu)
+                    {
+                        return node;
+                    }
+                }
+            }
+            return 0;
+        }
+        //
+        // Node the calling thread is running on right now. Unless the
+        // thread is pinned this may change at any time.
+        //
+        inline int currentNode()
+        {
+#if defined(__linux__) && defined(SYS_getcpu)
+            unsigned cpu = 0;
+            unsigned node = 0;
+            if(syscall(SYS_getcpu, &cpu, &node, nullptr) == 0)
+            {
+                return node;
+            }
+#endif
+            return 0;
+        }
+
+        namespace detail
+        {
+            //
+            // Values from linux/mempolicy.h, which isn't always
+            // installed.
+            //
+            enum
+            {
+                mpolDefault = 0,
+                mpolPreferred = 1,
+                mpolBind = 2,
+                mpolMfMove = 1 << 1
+            };
+            //
+            // Room for 1024 nodes. The kernel reads one bit less than
+            // the maxnode it's given.
+            //
+            struct NodeMask
+            {
+                static constexpr size_t bits = 1024;
+                static constexpr size_t wordBits = 8 * sizeof(unsigned long);
+                unsigned long words[bits / wordBits]{};
+
+                NodeMask(int node)
+                {
+                    words[node / wordBits] = 1UL << (node % wordBits);
+                }
+                static constexpr unsigned long maxNode = bits + 1;
+            };
+
+            inline bool valid(int node)
+            {
+                return node >= 0 && size_t(node) < NodeMask::bits;
+            }
+        }
+        //
+        // Put the pages of [data, data + size) on node. Pages already
+        // touched are moved. Partial pages at either end are included
+        // so neighbouring data may move too. Returns false if the
+        // pages couldn't be placed. On a single node there's nowhere
+        // else for them to be so that's never a failure.
+        //
+        inline bool bind(void* data, size_t size, int node)
+        {
+            if(node == anyNode || size == 0)
+            {
+                return true;
+            }
+            if(!detail::valid(node) || node >= nodes())
+            {
+                return false;
+            }
+#if defined(__linux__) && defined(SYS_mbind)
+            const uintptr_t pageSize = sysconf(_SC_PAGESIZE);
+            uintptr_t begin = reinterpret_cast<uintptr_t>(data) &
+                ~(pageSize - 1);
+            uintptr_t end = reinterpret_cast<uintptr_t>(data) + size;
+            detail::NodeMask mask(node);
+            if(syscall(SYS_mbind,
+                       begin,
+                       end - begin,
+                       int(detail::mpolBind),
+                       mask.words,
+                       detail::NodeMask::maxNode,
+                       unsigned(detail::mpolMfMove)) == 0)
+            {
+                return true;
+            }
+#endif
+            return nodes() == 1;
+        }
+        //
+        // While in scope memory the calling thread faults in comes
+        // from node if it has any free. Useful for anything a
+        // message owns, such as a string's buffer, that's allocated
+        // by the thread writing it. The thread's policy goes back to
+        // the system default afterwards.
+        //
+        class Preferred
+        {
+        public:
+            Preferred(int node): _set(setPolicy(detail::mpolPreferred, node)) {}
+            ~Preferred()
+            {
+                if(_set)
+                {
+                    setPolicy(detail::mpolDefault, anyNode);
+                }
+            }
+
+            Preferred(const Preferred&) = delete;
+            Preferred& operator=(const Preferred&) = delete;
+
+            explicit operator bool() const { return _set; }
+
+        private:
+            bool _set;
+
+            static bool setPolicy(int mode, int node)
+            {
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+                if(mode == detail::mpolDefault)
+                {
+                    return syscall(SYS_set_mempolicy, mode, nullptr, 0) == 0;
+                }
+                if(!detail::valid(node) || node >= nodes())
+                {
+                    return false;
+                }
+                detail::NodeMask mask(node);
+                return syscall(SYS_set_mempolicy,
+                               mode,
+                               mask.words,
+                               detail::NodeMask::maxNode) == 0;
+#else
+                (void)mode;
+                (void)node;
+                return false;
+#endif
+            }
+        };
+        //
+        // Pin the calling thread to node's CPUs. Returns false, and
+        // leaves the thread where it is, if the node has none.
+        //
+        inline bool runOn(int node)
+        {
+#ifdef __linux__
+            std::vector<int> nodeCpus = cpus(node);
+            if(nodeCpus.empty())
+            {
+                return nodes() == 1 && node == 0;
+            }
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for(int cpu: nodeCpus)
+            {
+                if(cpu < CPU_SETSIZE)
+                {
+                    CPU_SET(cpu, &set);
+                }
+            }
+            return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+            (void)node;
+            return true;
+#endif
+        }
+    }
+}
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef RING_H
 #define RING_H
 
+#include "span.h"
+
 #include <cstdint>
 #include <type_traits>
 #include <iterator>
@@ -38,7 +40,11 @@ namespace L3 // Low Latency Library
         using value_type = T;
         static constexpr Index size = 1L << log2size;
 
-        Ring(): _storage{} {}
+        //
+        // constexpr so that static rings are constant initialised and
+        // left in BSS. Pages are then only touched when they're used.
+        //
+        constexpr Ring(): _storage{} {}
 
         T& operator[](Index idx)
         {
@@ -52,6 +58,14 @@ namespace L3 // Low Latency Library
 
         const T* begin() const { return std::begin(_storage); }
         const T* end() const { return std::end(_storage); }
+        //
+        // Items [begin, end) as at most two spans. The second is only
+        // non-empty if the range wraps round the end of the ring.
+        //
+        Spans<T> spans(Index begin, Index end)
+        {
+            return split(_storage, begin, end);
+        }
 
         template<typename I>
         struct IteratorT: std::iterator<std::random_access_iterator_tag, T>
@@ -92,10 +106,13 @@ namespace L3 // Low Latency Library
         struct StaticIterator: std::iterator<std::random_access_iterator_tag, T>
         {
             using Ring = Ring;
+            using difference_type = std::ptrdiff_t;
+
             StaticIterator(Index i): _index(i) {}
             static constexpr Ring& _ring = r;
             T& operator*()  const { return _ring[_index]; }
             T* operator->() const { return &_ring[_index]; }
+            T& operator[](difference_type n) const { return _ring[_index + n]; }
 
             StaticIterator& operator++()
             {
@@ -109,6 +126,84 @@ namespace L3 // Low Latency Library
                 ++_index;
                 return result;
             }
+
+            StaticIterator& operator--()
+            {
+                --_index;
+                return *this;
+            }
+
+            StaticIterator operator--(int)
+            {
+                StaticIterator result{*this};
+                --_index;
+                return result;
+            }
+            //
+            // Offsets are templates so that they're an exact match
+            // for any integer. Otherwise converting to Index and
+            // using the builtin operators would be ambiguous.
+            //
+            template<typename I>
+            using IfIntegral = typename std::enable_if<
+                std::is_integral<I>::value, StaticIterator>::type;
+
+            template<typename I>
+            IfIntegral<I>& operator+=(I n)
+            {
+                _index += n;
+                return *this;
+            }
+
+            template<typename I>
+            IfIntegral<I>& operator-=(I n)
+            {
+                _index -= n;
+                return *this;
+            }
+
+            template<typename I>
+            IfIntegral<I> operator+(I n) const { return _index + n; }
+
+            template<typename I>
+            IfIntegral<I> operator-(I n) const { return _index - n; }
+
+            template<typename I>
+            friend IfIntegral<I> operator+(I n, const StaticIterator& i)
+            {
+                return i._index + n;
+            }
+
+            difference_type operator-(const StaticIterator& rhs) const
+            {
+                return _index - rhs._index;
+            }
+
+            bool operator==(const StaticIterator& rhs) const
+            {
+                return _index == rhs._index;
+            }
+            bool operator!=(const StaticIterator& rhs) const
+            {
+                return _index != rhs._index;
+            }
+            bool operator<(const StaticIterator& rhs) const
+            {
+                return _index < rhs._index;
+            }
+            bool operator>(const StaticIterator& rhs) const
+            {
+                return _index > rhs._index;
+            }
+            bool operator<=(const StaticIterator& rhs) const
+            {
+                return _index <= rhs._index;
+            }
+            bool operator>=(const StaticIterator& rhs) const
+            {
+                return _index >= rhs._index;
+            }
+
             operator Index() const { return _index; }
 
         private:
@@ -127,6 +222,21 @@ namespace L3 // Low Latency Library
         T _storage[size];
     };
 
+    //
+    // A Get or Put::Batch as at most two contiguous spans of the ring
+    // it's from. Lets a batch be processed with memcpy, std::
+    // algorithms or vectorised loops rather than an element at a time
+    // through an iterator that masks every index. Note the spans are
+    // of the ring's slots so they are only the messages themselves
+    // with LayoutPolicy::Packed.
+    //
+    template<typename Batch>
+    inline auto spans(const Batch& batch) ->
+        decltype(Batch::Iterator::_ring.spans(0, 0))
+    {
+        return Batch::Iterator::_ring.spans(batch.begin(), batch.end());
+    }
+
     template<typename OS, typename T, size_t log2size>
     OS& operator<<(OS& os, const Ring<T, log2size>& ring)
     {
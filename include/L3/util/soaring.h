@@ -0,0 +1,144 @@
+#ifndef SOARING_H
+#define SOARING_H
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "cacheline.h"
+#include "span.h"
+#include "types.h"
+
+#include <iterator>
+#include <tuple>
+
+namespace L3 // Low Latency Library
+{
+    /**
+     * A ring of tuples stored as a struct of arrays. Each field of
+     * the tuple has its own power of 2 sized array so a consumer
+     * interested in one field reads only that field's memory and can
+     * process a batch of them as contiguous spans.
+     *
+     * Indexing gives a tuple of references to the fields so rows can
+     * be read and assigned much like the Ts in a Ring.
+     */
+    template<typename T, size_t log2size>
+    class SoARing;
+
+    template<typename... Fields, size_t log2size>
+    class SoARing<std::tuple<Fields...>, log2size>
+    {
+        static_assert(log2size < 32, "Unreasonable RingBuf size.");
+        static_assert(log2size > 0, "Minimun ring size is 2");
+        static_assert(sizeof...(Fields) > 0, "No fields");
+
+    public:
+        using value_type = std::tuple<Fields...>;
+        using reference = std::tuple<Fields&...>;
+        static constexpr Index size = 1L << log2size;
+
+        template<size_t i>
+        using Field = typename std::tuple_element<i, value_type>::type;
+
+        constexpr SoARing(): _columns{} {}
+
+        reference operator[](Index idx)
+        {
+            static constexpr Index _mask = size - 1;
+            return row(
+                idx & _mask,
+                typename MakeIndices<sizeof...(Fields)>::type());
+        }
+        //
+        // Field i of the rows [begin, end) as at most two spans.
+        //
+        template<size_t i>
+        Spans<Field<i>> spans(Index begin, Index end)
+        {
+            return split(std::get<i>(_columns).data, begin, end);
+        }
+
+        template<SoARing& r>
+        struct StaticIterator:
+            std::iterator<std::forward_iterator_tag,
+                          value_type,
+                          std::ptrdiff_t,
+                          void,
+                          reference>
+        {
+            using Ring = SoARing;
+            StaticIterator(Index i): _index(i) {}
+            static constexpr Ring& _ring = r;
+            reference operator*() const { return _ring[_index]; }
+
+            StaticIterator& operator++()
+            {
+                ++_index;
+                return *this;
+            }
+
+            StaticIterator operator++(int)
+            {
+                StaticIterator result{*this};
+                ++_index;
+                return result;
+            }
+            operator Index() const { return _index; }
+
+        private:
+            Index _index;
+        };
+
+    private:
+        template<typename F>
+        struct L3_CACHE_LINE Column
+        {
+            F data[size];
+        };
+
+        std::tuple<Column<Fields>...> _columns;
+
+        template<size_t... i>
+        reference row(Index idx, Indices<i...>)
+        {
+            return reference(std::get<i>(_columns).data[idx]...);
+        }
+    };
+    //
+    // Field i of a batch of messages from a struct of arrays ring. For
+    // example to total the first field of a Get
+    //
+    //     for(auto& span: L3::column<0>(get))
+    //         for(auto& price: span)
+    //             total += price;
+    //
+    template<size_t i, typename Batch>
+    inline auto column(const Batch& batch) ->
+        decltype(Batch::Iterator::_ring.template spans<i>(0, 0))
+    {
+        return Batch::Iterator::_ring.template spans<i>(
+            batch.begin(), batch.end());
+    }
+}
+
+#endif
@@ -0,0 +1,76 @@
+#ifndef SPAN_H
+#define SPAN_H
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "types.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+namespace L3
+{
+    //
+    // A contiguous run of Ts.
+    //
+    template<typename T>
+    struct Span
+    {
+        T* _begin;
+        T* _end;
+
+        T* begin() const { return _begin; }
+        T* end() const { return _end; }
+        size_t size() const { return _end - _begin; }
+        bool empty() const { return _begin == _end; }
+        T& operator[](size_t i) const { return _begin[i]; }
+    };
+    //
+    // A range of a ring is contiguous unless it wraps round the end
+    // in which case it's in two parts. The second is empty if the
+    // range doesn't wrap.
+    //
+    template<typename T>
+    using Spans = std::array<Span<T>, 2>;
+    //
+    // Split [begin, end) of a ring stored in a power of 2 sized
+    // array into spans.
+    //
+    template<typename T, size_t size>
+    inline Spans<T> split(T (&storage)[size], Index begin, Index end)
+    {
+        static_assert(size && !(size & (size - 1)), "Size not power of 2");
+        static constexpr Index mask = size - 1;
+
+        T* first = storage + (begin & mask);
+        size_t count = end - begin;
+        size_t head = std::min<size_t>(count, size - (begin & mask));
+        return Spans<T>{{
+            Span<T>{first, first + head},
+            Span<T>{storage, storage + (count - head)}}};
+    }
+}
+
+#endif
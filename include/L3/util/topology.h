@@ -0,0 +1,243 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include "numa.h"
+
+#include <dirent.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace L3
+{
+    //
+    // Which CPUs share what, read from sysfs. For each online CPU we
+    // want its physical core, so we know its SMT siblings, the L2
+    // and L3 caches it shares and its package and NUMA node. Cache
+    // sharing is taken from shared_cpu_list with each cache
+    // identified by the lowest CPU sharing it.
+    //
+    // Anything missing is assumed not shared. With no sysfs at all
+    // we fall back to hardware_concurrency() CPUs with nothing known
+    // about them, so placement can only be round robin.
+    //
+    class Topology
+    {
+    public:
+        static constexpr int unknown = -1;
+
+        struct Cpu
+        {
+            int id;
+            int package;
+            int core;
+            int l2;
+            int l3;
+            int node;
+        };
+        //
+        // How close two CPUs are, nearest first.
+        //
+        enum Distance { same, smt, l2, l3, node, remote };
+
+        explicit Topology(const std::string& root = "/sys/devices/system/cpu")
+        {
+            for(int id: Numa::readList(root + "/online"))
+            {
+                _cpus.push_back(read(root + "/cpu" + std::to_string(id), id));
+            }
+            _known = !_cpus.empty();
+            if(!_known)
+            {
+                int n = std::max(1u, std::thread::hardware_concurrency());
+                for(int id = 0; id < n; ++id)
+                {
+                    _cpus.push_back(Cpu{id, 0, id, unknown, unknown, 0});
+                }
+            }
+        }
+        //
+        // False if we had to guess.
+        //
+        bool known() const { return _known; }
+
+        const std::vector<Cpu>& cpus() const { return _cpus; }
+
+        const Cpu* cpu(int id) const
+        {
+            for(auto& c: _cpus)
+            {
+                if(c.id == id)
+                {
+                    return &c;
+                }
+            }
+            return nullptr;
+        }
+
+        static Distance distance(const Cpu& a, const Cpu& b)
+        {
+            if(a.id == b.id)
+            {
+                return same;
+            }
+            if(a.package == b.package && a.core == b.core)
+            {
+                return smt;
+            }
+            if(a.l2 != unknown && a.l2 == b.l2)
+            {
+                return l2;
+            }
+            if(a.l3 != unknown && a.l3 == b.l3)
+            {
+                return l3;
+            }
+            return a.node == b.node ? node : remote;
+        }
+        //
+        // CPUs ordered so neighbours are as close as possible: by
+        // node, package, L3, L2 then core. One hardware thread of
+        // every core comes before any core's second so SMT siblings
+        // are only shared once there are more threads than cores.
+        //
+        std::vector<Cpu> ordered() const
+        {
+            std::vector<Cpu> result(_cpus);
+            std::vector<int> rank(result.size(), 0);
+            for(size_t i = 0; i < result.size(); ++i)
+            {
+                for(size_t j = 0; j < i; ++j)
+                {
+                    if(distance(result[i], result[j]) == smt)
+                    {
+                        ++rank[i];
+                    }
+                }
+            }
+            std::vector<size_t> order(result.size());
+            for(size_t i = 0; i < order.size(); ++i)
+            {
+                order[i] = i;
+            }
+            auto key = [&](size_t i)
+            {
+                const Cpu& c = result[i];
+                return std::make_tuple(rank[i],
+                                       c.node,
+                                       c.package,
+                                       c.l3,
+                                       c.l2,
+                                       c.core,
+                                       c.id);
+            };
+            std::sort(order.begin(),
+                      order.end(),
+                      [&](size_t a, size_t b){ return key(a) < key(b); });
+            std::vector<Cpu> sorted;
+            for(size_t i: order)
+            {
+                sorted.push_back(result[i]);
+            }
+            return sorted;
+        }
+
+    private:
+        std::vector<Cpu> _cpus;
+        bool _known;
+
+        static int readInt(const std::string& path, int otherwise)
+        {
+            std::ifstream is(path);
+            int result;
+            return is >> result ? result : otherwise;
+        }
+        //
+        // Lowest CPU sharing the cache at level, excluding
+        // instruction caches.
+        //
+        static int cache(const std::string& cpu, int level)
+        {
+            for(int i = 0; ; ++i)
+            {
+                std::string index = cpu + "/cache/index" + std::to_string(i);
+                int l = readInt(index + "/level", unknown);
+                if(l == unknown)
+                {
+                    return unknown;
+                }
+                std::ifstream type(index + "/type");
+                std::string t;
+                type >> t;
+                if(l == level && t != "Instruction")
+                {
+                    std::vector<int> shared =
+                        Numa::readList(index + "/shared_cpu_list");
+                    return shared.empty() ? unknown : shared.front();
+                }
+            }
+        }
+
+        static int nodeOf(const std::string& cpu)
+        {
+            int result = 0;
+            if(DIR* dir = opendir(cpu.c_str()))
+            {
+                while(dirent* entry = readdir(dir))
+                {
+                    std::string name(entry->d_name);
+                    if(name.size() > 4 && name.compare(0, 4, "node") == 0)
+                    {
+                        result = std::atoi(name.c_str() + 4);
+                        break;
+                    }
+                }
+                closedir(dir);
+            }
+            return result;
+        }
+
+        static Cpu read(const std::string& cpu, int id)
+        {
+            Cpu result;
+            result.id = id;
+            result.package =
+                readInt(cpu + "/topology/physical_package_id", 0);
+            result.core = readInt(cpu + "/topology/core_id", id);
+            result.l2 = cache(cpu, 2);
+            result.l3 = cache(cpu, 3);
+            result.node = nodeOf(cpu);
+            return result;
+        }
+    };
+}
+
+#endif
@@ -37,6 +37,16 @@ namespace L3
     // Generate a type for tagging purposes.
     //
     template<size_t t> struct Tag { static constexpr size_t tag = t; };
+    //
+    // Compile time sequence 0, 1, ..., n - 1 for unpacking tuples.
+    //
+    template<size_t...> struct Indices {};
+
+    template<size_t n, size_t... i>
+    struct MakeIndices: MakeIndices<n - 1, n - 1, i...> {};
+
+    template<size_t... i>
+    struct MakeIndices<0, i...> { using type = Indices<i...>; };
 }
 
 #endif
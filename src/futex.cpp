@@ -0,0 +1 @@
+#include <L3/util/futex.h>
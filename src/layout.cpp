@@ -0,0 +1 @@
+#include <L3/static/layout.h>
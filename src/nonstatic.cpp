@@ -0,0 +1 @@
+#include <L3/non_static/disruptor.h>
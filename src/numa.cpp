@@ -0,0 +1 @@
+#include <L3/util/numa.h>
@@ -0,0 +1 @@
+#include <../include/L3/util/soaring.h>
@@ -0,0 +1,148 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <L3/static/disruptor.h>
+#include <L3/util/scopedtimer.h>
+
+#include <iostream>
+#include <thread>
+#include <vector>
+//
+// Shared producers committing in claim order (CommitPolicy::Shared)
+// against committing through an availability buffer
+// (CommitPolicy::Available) for 2, 4 and 8 producers into one
+// consumer.
+//
+#ifndef L3_ITERATIONS
+#    define L3_ITERATIONS 10000000
+#endif 
+
+constexpr size_t iterations {L3_ITERATIONS};
+
+#ifndef L3_QSIZE
+#    define L3_QSIZE 17
+#endif
+
+using namespace std::chrono;
+using secs = duration<double>;
+
+struct Msg
+{
+    size_t producer;
+    size_t sequence;
+};
+
+template<typename D, typename Put, typename Get, size_t producers>
+bool run(const char* name)
+{
+    constexpr size_t perProducer = iterations / producers;
+
+    bool status = true;
+    L3::ScopedTimer<>::duration elapsed{0};
+    {
+        L3::ScopedTimer<> timer(elapsed);
+        std::vector<std::thread> threads;
+        for(size_t p = 0; p < producers; ++p)
+        {
+            threads.emplace_back(
+                [p]{
+                    for(size_t i = 1; i <= perProducer; ++i)
+                    {
+                        Put() = Msg{p, i};
+                    }
+                });
+        }
+        //
+        // Each producer's messages must arrive in order.
+        //
+        std::vector<size_t> previous(producers, 0);
+        for(size_t i = 0; i < perProducer * producers;)
+        {
+            for(auto& m: Get())
+            {
+                size_t& prev = previous[m.producer];
+                status &= m.sequence == prev + 1;
+                prev = m.sequence;
+                ++i;
+            }
+        }
+        for(auto& t: threads)
+        {
+            t.join();
+        }
+    }
+    std::cout << name << " " << producers << "P1C: throughput: "
+              << (perProducer * producers /
+                  duration_cast<secs>(elapsed).count()) / std::mega::num
+              << " M msgs/s" << std::endl;
+    return status;
+}
+
+template<size_t producers, size_t tag>
+bool runShared()
+{
+    using D = L3::Disruptor<Msg, L3_QSIZE, L3::Tag<tag>>;
+    using Get = typename D::template Get<>;
+    using Put = typename D::template Put<L3::Barrier<Get>,
+                                         L3::CommitPolicy::Shared>;
+    return run<D, Put, Get, producers>("Shared");
+}
+
+template<size_t producers, size_t tag>
+bool runAvailable()
+{
+    using D = L3::Disruptor<Msg, L3_QSIZE, L3::Tag<tag>>;
+    using Get = typename D::template Get<
+        void,
+        L3::Barrier<L3::AvailabilityBuffer<D>>>;
+    using Put = typename D::template Put<L3::Barrier<Get>,
+                                         L3::CommitPolicy::Available>;
+    return run<D, Put, Get, producers>("Available");
+}
+
+int
+main()
+{
+    bool status = true;
+
+    status &= runShared<2, 1200>();
+    std::cerr << "runShared<2>: " << status << std::endl;
+
+    status &= runAvailable<2, 1201>();
+    std::cerr << "runAvailable<2>: " << status << std::endl;
+
+    status &= runShared<4, 1210>();
+    std::cerr << "runShared<4>: " << status << std::endl;
+
+    status &= runAvailable<4, 1211>();
+    std::cerr << "runAvailable<4>: " << status << std::endl;
+
+    status &= runShared<8, 1220>();
+    std::cerr << "runShared<8>: " << status << std::endl;
+
+    status &= runAvailable<8, 1221>();
+    std::cerr << "runAvailable<8>: " << status << std::endl;
+
+    return status ? 0 : 1;
+}
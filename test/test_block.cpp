@@ -0,0 +1,186 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <L3/static/disruptor.h>
+#include <L3/static/spinpolicy.h>
+#include <L3/util/scopedtimer.h>
+
+#include <time.h>
+
+#include <iostream>
+#include <thread>
+//
+// Blocking wait strategy. Consumers and producers park on a futex
+// when there's nothing to do rather than burning a core.
+//
+#ifndef L3_ITERATIONS
+#    define L3_ITERATIONS 10000000
+#endif 
+
+constexpr size_t iterations {L3_ITERATIONS};
+
+using namespace std::chrono;
+using secs = duration<double>;
+using Block = L3::SpinPolicy::Block<>;
+//
+// CPU time used by the calling thread.
+//
+inline nanoseconds threadTime()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return seconds(ts.tv_sec) + nanoseconds(ts.tv_nsec);
+}
+//
+// Everyone blocks. Consumer waits on the producer and the producer
+// waits on a full ring.
+//
+namespace test1to1
+{
+    using D = L3::Disruptor<size_t, 8, L3::Tag<1400>>;
+    using Get = D::Get<void, L3::Barrier<D>, Block>;
+    using Put = D::Put<L3::Barrier<Get>, L3::CommitPolicy::Unique, Block>;
+
+    bool test()
+    {
+        std::thread producer(
+            []{
+                for(size_t i = 1; i < iterations; ++i)
+                {
+                    Put() = i;
+                }
+            });
+
+        bool status = true;
+        size_t previous = 0;
+        for(size_t i = 1; i < iterations;)
+        {
+            for(auto m: Get())
+            {
+                status &= m == previous + 1;
+                previous = m;
+                ++i;
+            }
+        }
+        producer.join();
+        return status;
+    }
+}
+//
+// Shared producers park waiting for each other to commit.
+//
+namespace test2to1
+{
+    using D = L3::Disruptor<size_t, 8, L3::Tag<1410>>;
+    using Get = D::Get<void, L3::Barrier<D>, Block>;
+    using Put = D::Put<L3::Barrier<Get>, L3::CommitPolicy::Shared,
+                       Block, Block>;
+
+    bool test()
+    {
+        auto produce = [](size_t first){
+            for(size_t i = first; i < iterations; i += 2)
+            {
+                Put() = i;
+            }
+        };
+        std::thread p1(produce, 1);
+        std::thread p2(produce, 2);
+
+        bool status = true;
+        size_t previous[2] = {0, 0};
+        for(size_t i = 1; i < iterations;)
+        {
+            for(auto m: Get())
+            {
+                size_t& prev = previous[m & 1];
+                status &= prev == 0 ? m <= 2 : m == prev + 2;
+                prev = m;
+                ++i;
+            }
+        }
+        p1.join();
+        p2.join();
+        return status;
+    }
+}
+//
+// A consumer on an idle disruptor should use next to no CPU and
+// still wake promptly when something arrives.
+//
+namespace testIdle
+{
+    template<typename SpinPolicy, size_t tag>
+    nanoseconds idle(const char* name, milliseconds wait)
+    {
+        using D = L3::Disruptor<size_t, 8, L3::Tag<tag>>;
+        using Get = typename D::template Get<void, L3::Barrier<D>, SpinPolicy>;
+        using Put = typename D::template Put<L3::Barrier<Get>>;
+
+        nanoseconds cpu;
+        steady_clock::time_point received;
+        std::thread consumer(
+            [&]{
+                nanoseconds start = threadTime();
+                Get g;
+                received = steady_clock::now();
+                cpu = threadTime() - start;
+            });
+        std::this_thread::sleep_for(wait);
+        steady_clock::time_point sent = steady_clock::now();
+        Put() = 1;
+        consumer.join();
+
+        std::cout << name << ": idle " << wait.count() << "ms, cpu: "
+                  << duration_cast<microseconds>(cpu).count()
+                  << "us, wake up: "
+                  << duration_cast<microseconds>(received - sent).count()
+                  << "us" << std::endl;
+        return cpu;
+    }
+
+    bool test()
+    {
+        constexpr milliseconds wait(200);
+        idle<L3::NoOp, 1420>("NoOp", wait);
+        return idle<Block, 1430>("Block", wait) < wait / 10;
+    }
+}
+
+int
+main()
+{
+    bool status = true;
+
+    status &= test1to1::test();
+    std::cerr << "test1to1::test: " << status << std::endl;
+
+    status &= test2to1::test();
+    std::cerr << "test2to1::test: " << status << std::endl;
+
+    status &= testIdle::test();
+    std::cerr << "testIdle::test: " << status << std::endl;
+
+    return status ? 0 : 1;
+}
@@ -0,0 +1,213 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <L3/static/blockput.h>
+#include <L3/static/disruptor.h>
+#include <L3/static/spinpolicy.h>
+#include <L3/util/scopedtimer.h>
+
+#include <iostream>
+#include <thread>
+#include <vector>
+//
+// Shared producers publishing K messages per claim for K = 1, 8 and
+// 64 with 2, 4 and 8 producers into one consumer. Everyone yields
+// while waiting so results still mean something when there are more
+// threads than cores.
+//
+#ifndef L3_ITERATIONS
+#    define L3_ITERATIONS 10000000
+#endif 
+
+constexpr size_t iterations {L3_ITERATIONS};
+
+#ifndef L3_QSIZE
+#    define L3_QSIZE 17
+#endif
+
+using namespace std::chrono;
+using secs = duration<double>;
+
+struct Msg
+{
+    size_t producer;
+    size_t sequence;
+};
+
+template<size_t producers, size_t K, size_t tag>
+bool run()
+{
+    using D = L3::Disruptor<Msg, L3_QSIZE, L3::Tag<tag>>;
+    using Spin = L3::SpinPolicy::Yield;
+    using Get = typename D::template Get<void, L3::Barrier<D>, Spin>;
+    using Put = typename D::template Put<L3::Barrier<Get>,
+                                         L3::CommitPolicy::Shared,
+                                         Spin,
+                                         Spin>;
+
+    constexpr size_t perProducer = iterations / producers;
+
+    bool status = true;
+    L3::ScopedTimer<>::duration elapsed{0};
+    {
+        L3::ScopedTimer<> timer(elapsed);
+        std::vector<std::thread> threads;
+        for(size_t p = 0; p < producers; ++p)
+        {
+            threads.emplace_back(
+                [p]{
+                    L3::BlockPut<Put, K> out;
+                    for(size_t i = 1; i <= perProducer; ++i)
+                    {
+                        out.put(Msg{p, i});
+                    }
+                });
+        }
+        //
+        // Each producer's messages must arrive in order. The last
+        // partial block is flushed when the producer's BlockPut goes
+        // out of scope.
+        //
+        std::vector<size_t> previous(producers, 0);
+        for(size_t i = 0; i < perProducer * producers;)
+        {
+            for(auto& m: Get())
+            {
+                size_t& prev = previous[m.producer];
+                status &= m.sequence == prev + 1;
+                prev = m.sequence;
+                ++i;
+            }
+        }
+        for(auto& t: threads)
+        {
+            t.join();
+        }
+    }
+    std::cout << producers << "P1C K=" << K << ": throughput: "
+              << (perProducer * producers /
+                  duration_cast<secs>(elapsed).count()) / std::mega::num
+              << " M msgs/s" << std::endl;
+    return status;
+}
+
+template<size_t producers, size_t tag>
+bool runBlocks()
+{
+    bool status = true;
+    status &= run<producers, 1, tag>();
+    status &= run<producers, 8, tag + 1>();
+    status &= run<producers, 64, tag + 2>();
+    return status;
+}
+
+namespace testFlush
+{
+    using D = L3::Disruptor<size_t, 4, L3::Tag<1330>>;
+    using Get = D::Get<>;
+    using Put = D::Put<L3::Barrier<Get>, L3::CommitPolicy::Shared>;
+
+    bool test()
+    {
+        L3::BlockPut<Put, 4> out{std::chrono::milliseconds(1)};
+        //
+        // Nothing goes until the block fills...
+        //
+        for(size_t i = 0; i < 3; ++i)
+        {
+            out.put(i);
+        }
+        if(out.size() != 3 || Get(Get::noBlock).begin() !=
+           Get(Get::noBlock).end())
+        {
+            return false;
+        }
+        out.put(3);
+        if(out.size() != 0)
+        {
+            return false;
+        }
+        size_t expected = 0;
+        for(auto m: Get(Get::noBlock))
+        {
+            if(m != expected++)
+            {
+                return false;
+            }
+        }
+        //
+        // ...is flushed explicitly...
+        //
+        out.put(4);
+        out.flush();
+        for(auto m: Get(Get::noBlock))
+        {
+            if(m != expected++)
+            {
+                return false;
+            }
+        }
+        //
+        // ...or has been waiting too long.
+        //
+        out.put(5);
+        if(out.poll())
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        if(!out.poll())
+        {
+            return false;
+        }
+        for(auto m: Get(Get::noBlock))
+        {
+            if(m != expected++)
+            {
+                return false;
+            }
+        }
+        return expected == 6;
+    }
+}
+
+int
+main()
+{
+    bool status = true;
+
+    status &= testFlush::test();
+    std::cerr << "testFlush::test: " << status << std::endl;
+
+    status &= runBlocks<2, 1300>();
+    std::cerr << "runBlocks<2>: " << status << std::endl;
+
+    status &= runBlocks<4, 1310>();
+    std::cerr << "runBlocks<4>: " << status << std::endl;
+
+    status &= runBlocks<8, 1320>();
+    std::cerr << "runBlocks<8>: " << status << std::endl;
+
+    return status ? 0 : 1;
+}
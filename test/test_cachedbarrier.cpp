@@ -0,0 +1,197 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <L3/static/disruptor.h>
+#include <L3/static/spinpolicy.h>
+#include <L3/util/scopedtimer.h>
+
+#include <iostream>
+#include <thread>
+//
+// How often producers and consumers read each other's cursors. Before
+// caching the barrier every Put read the consumers' cursors and every
+// Get the producer's, so the producer made one read per message. Now
+// they are only read when the cached value would mean waiting.
+//
+// Each read of a cursor another core is writing is a coherence miss
+// (a HITM). To see those directly run under perf, eg
+//
+//     perf c2c record ./test_cachedbarrier
+//     perf c2c report --stdio
+//
+// and look at the lines holding the cursors.
+//
+#ifndef L3_ITERATIONS
+#    define L3_ITERATIONS 10000000
+#endif 
+
+constexpr size_t iterations {L3_ITERATIONS};
+
+#ifndef L3_QSIZE
+#    define L3_QSIZE 15
+#endif
+
+using namespace std::chrono;
+using secs = duration<double>;
+//
+// Yield rather than busy spin so that reads made while waiting don't
+// swamp the count when there are fewer cores than threads.
+//
+using Spin = L3::SpinPolicy::Yield;
+//
+// Barrier that counts how many times it's read.
+//
+template<typename Barrier>
+struct CountingBarrier
+{
+    static L3::Index least()
+    {
+        reads.fetch_add(1, std::memory_order_relaxed);
+        return Barrier::least();
+    }
+    static L3::Counter reads;
+};
+
+template<typename Barrier>
+L3::Counter CountingBarrier<Barrier>::reads{0};
+
+template<typename Get>
+bool consume()
+{
+    bool status = true;
+    size_t previous = 0;
+    for(size_t i = 1; i < iterations;)
+    {
+        for(auto m: Get())
+        {
+            status &= m == previous + 1;
+            previous = m;
+            ++i;
+        }
+    }
+    return status;
+}
+
+template<typename Barrier>
+double perMsg()
+{
+    return double(Barrier::reads) / iterations;
+}
+
+namespace test1P1C
+{
+    using D = L3::Disruptor<size_t, L3_QSIZE, L3::Tag<1100>>;
+
+    using ConsumerBarrier = CountingBarrier<L3::Barrier<D>>;
+    using Get = D::Get<void, ConsumerBarrier, Spin>;
+
+    using ProducerBarrier = CountingBarrier<L3::Barrier<Get>>;
+    using Put = D::Put<ProducerBarrier, L3::CommitPolicy::Unique, Spin>;
+
+    bool test()
+    {
+        bool status;
+        L3::ScopedTimer<>::duration elapsed{0};
+        {
+            L3::ScopedTimer<> timer(elapsed);
+            std::thread producer(
+                []{
+                    for(size_t i = 1; i < iterations; ++i)
+                    {
+                        Put() = i;
+                    }
+                });
+            status = consume<Get>();
+            producer.join();
+        }
+        std::cout << "1P1C: throughput: "
+                  << (iterations / duration_cast<secs>(elapsed).count()) /
+                     std::mega::num
+                  << " M msgs/s, producer reads/msg: "
+                  << perMsg<ProducerBarrier>()
+                  << ", consumer reads/msg: " << perMsg<ConsumerBarrier>()
+                  << std::endl;
+        return status;
+    }
+}
+
+namespace test1P3C
+{
+    using D = L3::Disruptor<size_t, L3_QSIZE, L3::Tag<1110>>;
+
+    using ConsumerBarrier = CountingBarrier<L3::Barrier<D>>;
+    using Get1 = D::Get<L3::Tag<1>, ConsumerBarrier, Spin>;
+    using Get2 = D::Get<L3::Tag<2>, ConsumerBarrier, Spin>;
+    using Get3 = D::Get<L3::Tag<3>, ConsumerBarrier, Spin>;
+
+    using ProducerBarrier = CountingBarrier<L3::Barrier<Get1, Get2, Get3>>;
+    using Put = D::Put<ProducerBarrier, L3::CommitPolicy::Unique, Spin>;
+
+    bool test()
+    {
+        bool status1;
+        bool status2;
+        bool status3;
+        L3::ScopedTimer<>::duration elapsed{0};
+        {
+            L3::ScopedTimer<> timer(elapsed);
+            std::thread producer(
+                []{
+                    for(size_t i = 1; i < iterations; ++i)
+                    {
+                        Put() = i;
+                    }
+                });
+            std::thread consumer1([&]{ status1 = consume<Get1>(); });
+            std::thread consumer2([&]{ status2 = consume<Get2>(); });
+            status3 = consume<Get3>();
+            consumer1.join();
+            consumer2.join();
+            producer.join();
+        }
+        std::cout << "1P3C: throughput: "
+                  << (iterations / duration_cast<secs>(elapsed).count()) /
+                     std::mega::num
+                  << " M msgs/s, producer reads/msg: "
+                  << perMsg<ProducerBarrier>()
+                  << ", consumer reads/msg: "
+                  << perMsg<ConsumerBarrier>() / 3
+                  << std::endl;
+        return status1 && status2 && status3;
+    }
+}
+
+int
+main()
+{
+    bool status = true;
+
+    status &= test1P1C::test();
+    std::cerr << "test1P1C::test: " << status << std::endl;
+
+    status &= test1P3C::test();
+    std::cerr << "test1P3C::test: " << status << std::endl;
+
+    return status ? 0 : 1;
+}
@@ -0,0 +1,401 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <L3/static/consume.h>
+#include <L3/static/disruptor.h>
+#include <L3/static/processor.h>
+#include <L3/static/selector.h>
+#include <L3/static/spinpolicy.h>
+#include <L3/util/scopedtimer.h>
+
+#include <iostream>
+#include <iterator>
+#include <thread>
+#include <vector>
+//
+// Handlers taking messages one at a time, with their sequence
+// number and end of batch flag, or a whole batch at once.
+//
+#ifndef L3_ITERATIONS
+#    define L3_ITERATIONS 10000000
+#endif 
+
+constexpr size_t iterations {L3_ITERATIONS};
+
+#ifndef L3_QSIZE
+#    define L3_QSIZE 17
+#endif
+
+using namespace std::chrono;
+using secs = duration<double>;
+using Msg = size_t;
+using Spin = L3::SpinPolicy::Yield;
+//
+// Counts messages and batches each way a handler can see them.
+//
+struct PerMessage
+{
+    size_t messages{0};
+    size_t batches{0};
+    Msg last{0};
+    bool status{true};
+
+    void operator()(Msg m)
+    {
+        status &= m == last + 1;
+        last = m;
+        ++messages;
+    }
+    void endOfBatch() { ++batches; }
+};
+
+struct PerEvent
+{
+    using Handles = L3::Handles::Events;
+
+    size_t messages{0};
+    size_t batches{0};
+    Msg last{0};
+    L3::Index sequence{0};
+    bool status{true};
+
+    void operator()(Msg m, L3::Index s, bool endOfBatch)
+    {
+        status &= m == last + 1 && (sequence == 0 || s == sequence + 1);
+        last = m;
+        sequence = s;
+        ++messages;
+        batches += endOfBatch;
+    }
+};
+
+struct PerBatch
+{
+    using Handles = L3::Handles::Batches;
+
+    size_t messages{0};
+    size_t batches{0};
+    Msg last{0};
+    bool status{true};
+
+    template<typename Batch>
+    void operator()(const Batch& batch)
+    {
+        status &= batch.begin() != batch.end();
+        for(Msg m: batch)
+        {
+            status &= m == last + 1;
+            last = m;
+            ++messages;
+        }
+        ++batches;
+    }
+};
+
+namespace testBatches
+{
+    bool sequenced(const PerEvent& e, L3::Index last)
+    {
+        return e.sequence == last;
+    }
+
+    template<typename Handler>
+    bool sequenced(const Handler&, L3::Index)
+    {
+        return true;
+    }
+    //
+    // Publish the same batches for each handler then check they saw
+    // them.
+    //
+    template<typename Handler, size_t tag>
+    bool check()
+    {
+        using D = L3::Disruptor<Msg, 6, L3::Tag<tag>>;
+        using Get = typename D::template Get<>;
+        using Put = typename D::template Put<>;
+
+        Handler h;
+        Msg next = 1;
+        for(size_t n: {1, 5, 3, 0, 7})
+        {
+            {
+                typename Put::Batch batch(n);
+                for(auto& slot: batch)
+                {
+                    slot = next++;
+                }
+            }
+            L3::handle(h, Get(Get::noBlock));
+        }
+        //
+        // Sequence numbers start at the ring size and the empty batch
+        // isn't handed over.
+        //
+        return h.status && sequenced(h, D::size + next - 2) &&
+            h.messages == next - 1 && h.batches == 4;
+    }
+
+    bool test()
+    {
+        return check<PerMessage, 2400>() &&
+            check<PerEvent, 2401>() &&
+            check<PerBatch, 2402>();
+    }
+}
+
+namespace testStop
+{
+    using D = L3::Disruptor<Msg, 6, L3::Tag<2410>>;
+    using Get = D::Get<>;
+    using Put = D::Put<>;
+    //
+    // Stopping part way through a batch ends it there for per
+    // message handlers.
+    //
+    bool test()
+    {
+        for(Msg i = 1; i <= 6; ++i)
+        {
+            Put() = i;
+        }
+        auto three = [](Msg m){ return m == 3; };
+        PerEvent e;
+        bool stopped = L3::handle(e, Get(3), three);
+        bool status = stopped && e.messages == 3 && e.batches == 1;
+
+        PerMessage m;
+        m.last = 3;
+        stopped = L3::handle(m, Get(Get::noBlock), three);
+        return status && !stopped && m.messages == 3 && m.batches == 1;
+    }
+}
+
+namespace testSelector
+{
+    using D1 = L3::Disruptor<Msg, 6, L3::Tag<2420>>;
+    using D2 = L3::Disruptor<Msg, 6, L3::Tag<2421>>;
+
+    //
+    // Selector handlers are default constructed for each select()
+    // so keep what they see in statics.
+    //
+    PerEvent e;
+    PerBatch b;
+
+    struct Event
+    {
+        using Handles = L3::Handles::Events;
+
+        void operator()(Msg m, L3::Index s, bool endOfBatch)
+        {
+            e(m, s, endOfBatch);
+        }
+    };
+
+    struct Batch
+    {
+        using Handles = L3::Handles::Batches;
+
+        template<typename B>
+        void operator()(const B& batch) { b(batch); }
+    };
+
+    using Selector = L3::Selector<D1::Get<>, Event, D2::Get<>, Batch>;
+
+    bool test()
+    {
+        for(Msg i = 1; i <= 10; ++i)
+        {
+            D1::Put<>() = i;
+            D2::Put<>() = i;
+        }
+        size_t n = Selector::select();
+        return n == 20 && Selector::select() == 0 &&
+            e.status && e.messages == 10 && e.batches == 1 &&
+            b.status && b.messages == 10 && b.batches == 1;
+    }
+}
+
+namespace testConsume
+{
+    //
+    // Through consume() to an end of stream marker, which is the
+    // last message handed over and ends the final batch.
+    //
+    template<typename Handler, size_t tag>
+    bool run(const char* name)
+    {
+        using D = L3::Disruptor<Msg, L3_QSIZE, L3::Tag<tag>>;
+        using Get = typename D::template Get<L3::Tag<0>, L3::Barrier<D>, Spin>;
+        using Put = typename D::template Put<L3::Barrier<Get>,
+                                             L3::CommitPolicy::Unique,
+                                             Spin>;
+        Handler h;
+        h.last = 0;
+        L3::ScopedTimer<>::duration elapsed{0};
+        {
+            L3::ScopedTimer<> timer(elapsed);
+            std::thread producer(
+                []
+                {
+                    for(Msg i = 1; i < iterations; ++i)
+                    {
+                        Put() = i;
+                    }
+                    Put() = iterations;
+                });
+            struct EOS
+            {
+                bool operator()(Msg m) const { return m == iterations; }
+            } eos;
+            L3::consume<Get>(eos, h);
+            producer.join();
+        }
+        std::cout << name << ": batches: " << h.batches
+                  << ", throughput: "
+                  << (iterations / duration_cast<secs>(elapsed).count()) /
+            std::mega::num
+                  << " M msgs/s" << std::endl;
+        return h.status && h.messages == iterations && h.batches > 0;
+    }
+
+    bool test()
+    {
+        return run<PerMessage, 2430>("per message") &&
+            run<PerEvent, 2431>("per event") &&
+            run<PerBatch, 2432>("per batch");
+    }
+}
+
+//
+// Handlers that would accept a whole batch, or anything, still take
+// messages one at a time unless they opt in.
+//
+namespace testGeneric
+{
+    using D = L3::Disruptor<Msg, 6, L3::Tag<2440>>;
+    using Get = D::Get<>;
+    using Put = D::Put<>;
+
+    struct Templated
+    {
+        size_t calls{0};
+        Msg sum{0};
+
+        template<typename T>
+        void operator()(const T& m)
+        {
+            ++calls;
+            sum += m;
+        }
+    };
+
+    bool test()
+    {
+        L3::CheckEOS<Msg, 5> eos(1);
+        for(Msg i = 1; i <= 5; ++i)
+        {
+            Put() = i;
+        }
+        Templated t;
+        L3::consume<Get>(eos, t);
+        bool status = t.calls == 5 && t.sum == 15;
+#if __cplusplus >= 201402L
+        for(Msg i = 1; i <= 5; ++i)
+        {
+            Put() = i;
+        }
+        Msg sum = 0;
+        L3::CheckEOS<Msg, 5> again(1);
+        L3::consume<Get>(again, [&](auto& m) { sum += m; });
+        status &= sum == 15;
+#endif
+        return status;
+    }
+}
+//
+// Callables opted in with events() and batches().
+//
+namespace testOpted
+{
+    using D = L3::Disruptor<Msg, 6, L3::Tag<2450>>;
+    using Get = D::Get<>;
+    using Put = D::Put<>;
+
+    bool test()
+    {
+        for(Msg i = 1; i <= 5; ++i)
+        {
+            Put() = i;
+        }
+        size_t ends = 0;
+        L3::Index first = 0;
+        auto e = L3::events(
+            [&](Msg, L3::Index s, bool endOfBatch)
+            {
+                first = first ? first : s;
+                ends += endOfBatch;
+            });
+        L3::handle(e, Get(3));
+
+        size_t batches = 0;
+        size_t messages = 0;
+        auto b = L3::batches(
+            [&](const Get& batch)
+            {
+                ++batches;
+                messages += std::distance(batch.begin(), batch.end());
+            });
+        L3::handle(b, Get(Get::noBlock));
+        return first == D::size && ends == 1 &&
+            batches == 1 && messages == 2;
+    }
+}
+
+int
+main()
+{
+    bool status = true;
+
+    status &= testBatches::test();
+    std::cerr << "testBatches::test: " << status << std::endl;
+
+    status &= testStop::test();
+    std::cerr << "testStop::test: " << status << std::endl;
+
+    status &= testSelector::test();
+    std::cerr << "testSelector::test: " << status << std::endl;
+
+    status &= testConsume::test();
+    std::cerr << "testConsume::test: " << status << std::endl;
+
+    status &= testGeneric::test();
+    std::cerr << "testGeneric::test: " << status << std::endl;
+
+    status &= testOpted::test();
+    std::cerr << "testOpted::test: " << status << std::endl;
+
+    return status ? 0 : 1;
+}
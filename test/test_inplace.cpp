@@ -0,0 +1,215 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <L3/static/disruptor.h>
+#include <L3/static/pipeline.h>
+#include <L3/static/spinpolicy.h>
+#include <L3/util/scopedtimer.h>
+
+#include <iostream>
+#include <thread>
+//
+// The topology from examples/complex.cpp two ways. Producers P1 and
+// P2 feed C1 and C2 and then C3, which works out a result for C4.
+//
+// Bridged, as in the example, C3 copies each message with its
+// result into a second disruptor for C4:
+//
+//     P1,P2 - D1 - C1,C2 - C3 - D2 - C4
+//
+// In place C3 writes the result into the slot and C4 gates on C3 in
+// the same ring:
+//
+//     P1,P2 - D1 - C1,C2 - C3 - C4
+//
+#ifndef L3_ITERATIONS
+#    define L3_ITERATIONS 10000000
+#endif 
+
+constexpr size_t iterations {L3_ITERATIONS};
+
+#ifndef L3_QSIZE
+#    define L3_QSIZE 17
+#endif
+
+using namespace std::chrono;
+using secs = duration<double>;
+using Spin = L3::SpinPolicy::Yield;
+using L3::After;
+using L3::Stage;
+
+struct Msg
+{
+    size_t value;
+    size_t result;
+};
+
+inline size_t result(size_t value) { return value * 3 + 1; }
+//
+// Check each producer's messages arrive in order and, once C3 has
+// been, carry the right result. Producers send odd numbers from 3
+// and even ones from 2.
+//
+template<size_t id, bool hasResult>
+struct Check
+{
+    static size_t count;
+    static bool status;
+    static size_t previous[2];
+
+    void operator()(const Msg& m)
+    {
+        size_t& prev = previous[m.value % 2];
+        status &= prev == 0 ? m.value < 4 : m.value == prev + 2;
+        status &= !hasResult || m.result == result(m.value);
+        prev = m.value;
+        ++count;
+    }
+};
+
+template<size_t id, bool hasResult>
+size_t Check<id, hasResult>::count{0};
+template<size_t id, bool hasResult>
+bool Check<id, hasResult>::status{true};
+template<size_t id, bool hasResult>
+size_t Check<id, hasResult>::previous[2];
+
+template<typename C1, typename C2, typename C4>
+bool checked(size_t n)
+{
+    return C1::status && C1::count == n &&
+        C2::status && C2::count == n &&
+        C4::status && C4::count == n;
+}
+
+template<typename Put>
+void produce(size_t first)
+{
+    for(size_t i = first; i <= iterations; i += 2)
+    {
+        Put() = Msg{i, 0};
+    }
+}
+
+template<typename Threads, typename Put>
+double run()
+{
+    L3::ScopedTimer<>::duration elapsed{0};
+    {
+        L3::ScopedTimer<> timer(elapsed);
+        Threads threads;
+        threads.start();
+        std::thread p1(produce<Put>, 3);
+        std::thread p2(produce<Put>, 2);
+        p1.join();
+        p2.join();
+        threads.halt();
+    }
+    return (iterations / duration_cast<secs>(elapsed).count()) /
+        std::mega::num;
+}
+
+namespace testBridged
+{
+    using C1 = Check<2200, false>;
+    using C2 = Check<2201, false>;
+    using C4 = Check<2202, true>;
+
+    using D2 = L3::Disruptor<Msg, L3_QSIZE, L3::Tag<2210>>;
+    using Out = L3::Pipeline<D2, 1, Stage<C4>>;
+
+    struct C3
+    {
+        void operator()(const Msg& m)
+        {
+            Out::PutWith<Spin, Spin>() = Msg{m.value, result(m.value)};
+        }
+    };
+
+    using D1 = L3::Disruptor<Msg, L3_QSIZE, L3::Tag<2211>>;
+    using In = L3::Pipeline<D1, 2,
+                            Stage<C1>,
+                            Stage<C2>,
+                            Stage<C3, After<C1, C2>>>;
+    //
+    // The bridge's own thread in In is halted before C4's in Out.
+    //
+    struct Threads
+    {
+        In::Threads<Spin> in;
+        Out::Threads<Spin> out;
+
+        void start() { out.start(); in.start(); }
+        void halt() { in.halt(); out.halt(); }
+    };
+
+    bool test()
+    {
+        double throughput = run<Threads, In::PutWith<Spin, Spin>>();
+        std::cout << "bridged: throughput: " << throughput << " M msgs/s"
+                  << std::endl;
+        return checked<C1, C2, C4>(iterations - 1);
+    }
+}
+
+namespace testInPlace
+{
+    using C1 = Check<2220, false>;
+    using C2 = Check<2221, false>;
+    using C4 = Check<2222, true>;
+
+    struct C3
+    {
+        void operator()(Msg& m) { m.result = result(m.value); }
+    };
+
+    using D = L3::Disruptor<Msg, L3_QSIZE, L3::Tag<2230>>;
+    using P = L3::Pipeline<D, 2,
+                           Stage<C1>,
+                           Stage<C2>,
+                           Stage<C3, After<C1, C2>, L3::Writes>,
+                           Stage<C4, After<C3>>>;
+
+    bool test()
+    {
+        double throughput = run<P::Threads<Spin>, P::PutWith<Spin, Spin>>();
+        std::cout << "in place: throughput: " << throughput << " M msgs/s"
+                  << std::endl;
+        return checked<C1, C2, C4>(iterations - 1);
+    }
+}
+
+int
+main()
+{
+    bool status = true;
+
+    status &= testBridged::test();
+    std::cerr << "testBridged::test: " << status << std::endl;
+
+    status &= testInPlace::test();
+    std::cerr << "testInPlace::test: " << status << std::endl;
+
+    return status ? 0 : 1;
+}
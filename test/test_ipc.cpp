@@ -0,0 +1,258 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <L3/non_static/disruptor.h>
+#include <L3/static/spinpolicy.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+//
+// Disruptors shared between processes. The producer runs in a forked
+// child and the consumer in the parent.
+//
+#ifndef L3_ITERATIONS
+#    define L3_ITERATIONS 100000
+#endif 
+
+constexpr size_t iterations {L3_ITERATIONS};
+
+using namespace std::chrono;
+using Clock = steady_clock;
+
+namespace NS = L3::NonStatic;
+
+using Spin = L3::SpinPolicy::Yield;
+using Msg = Clock::time_point;
+using D = NS::Disruptor<Msg>;
+using Producer = NS::Producer<Msg, NS::CommitPolicy::Unique, Spin>;
+using Consumer = NS::Consumer<Msg, Spin>;
+
+const std::string name = "/L3_test_ipc_" + std::to_string(getpid());
+//
+// Send timestamps one at a time, waiting for each to be consumed so
+// that we measure latency rather than queueing.
+//
+void produce(D& d)
+{
+    Producer producer(d, NS::Barrier(d.consumerCursor(0)));
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        Producer::Put{producer} = Clock::now();
+        L3::Index sent = d.cursor().load(std::memory_order_relaxed);
+        while(d.consumerCursor(0).load(std::memory_order_acquire) < sent)
+        {
+            Spin()();
+        }
+    }
+}
+
+bool consume(const char* name, D& d)
+{
+    std::vector<Clock::duration> latencies;
+    latencies.reserve(iterations);
+    Consumer consumer(d, NS::Barrier(d), 0);
+    while(latencies.size() < iterations)
+    {
+        for(Msg& sent: Consumer::Get(consumer))
+        {
+            latencies.push_back(Clock::now() - sent);
+        }
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p)
+    {
+        return duration_cast<nanoseconds>(
+            latencies[size_t(p * (iterations - 1))]).count();
+    };
+    std::cout << name
+              << ": p50: " << percentile(0.5) << "ns"
+              << ", p99: " << percentile(0.99) << "ns"
+              << ", p99.9: " << percentile(0.999) << "ns"
+              << std::endl;
+    return latencies.size() == iterations;
+}
+
+bool waitChild(pid_t child)
+{
+    int status;
+    return waitpid(child, &status, 0) == child &&
+        WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+//
+// Child attaches by name.
+//
+namespace testNamed
+{
+    bool test()
+    {
+        D d(D::create, name, 12, 1);
+        pid_t child = fork();
+        if(child == 0)
+        {
+            D attached(D::attach, name);
+            produce(attached);
+            _exit(0);
+        }
+        bool status = consume("named", d);
+        return waitChild(child) && status;
+    }
+}
+//
+// Child inherits an anonymous shared mapping.
+//
+namespace testForked
+{
+    bool test()
+    {
+        D d(12, 1, L3::Memory::shared);
+        pid_t child = fork();
+        if(child == 0)
+        {
+            produce(d);
+            _exit(0);
+        }
+        bool status = consume("forked", d);
+        return waitChild(child) && status;
+    }
+}
+//
+// Threads in one process for comparison.
+//
+namespace testThreads
+{
+    bool test()
+    {
+        D d(12, 1);
+        std::thread producer([&]{ produce(d); });
+        bool status = consume("threads", d);
+        producer.join();
+        return status;
+    }
+}
+//
+// Attaching to something that isn't there or isn't what we expect
+// fails.
+//
+namespace testAttach
+{
+    bool test()
+    {
+        try
+        {
+            D d(D::attach, name + "_missing");
+            return false;
+        }
+        catch(const std::system_error&)
+        {
+        }
+
+        D d(D::create, name, 4, 1);
+        try
+        {
+            NS::Disruptor<char> wrong(NS::Disruptor<char>::attach, name);
+            return false;
+        }
+        catch(const std::runtime_error&)
+        {
+        }
+        D attached(D::attach, name);
+        return attached.size() == d.size();
+    }
+}
+//
+// Creating over a live object fails unless asked to replace it.
+//
+namespace testCreate
+{
+    bool test()
+    {
+        D d(D::create, name, 4, 1);
+        try
+        {
+            D again(D::create, name, 4, 1);
+            return false;
+        }
+        catch(const std::system_error& e)
+        {
+            if(e.code().value() != EEXIST)
+            {
+                return false;
+            }
+        }
+        D replacement(D::replace, name, 5, 1);
+        D attached(D::attach, name);
+        return attached.size() == replacement.size() &&
+            replacement.size() != d.size();
+    }
+    //
+    // A create that fails part way, here because the object is far
+    // too big to map, doesn't leave the name taken.
+    //
+    bool failed()
+    {
+        const std::string big = name + "_big";
+        try
+        {
+            L3::Memory::create(big, size_t(1) << 62);
+            return false;
+        }
+        catch(const std::system_error&)
+        {
+        }
+        L3::Memory m = L3::Memory::create(big, 4096);
+        return m.size() == 4096;
+    }
+}
+
+int
+main()
+{
+    bool status = true;
+
+    status &= testAttach::test();
+    std::cerr << "testAttach::test: " << status << std::endl;
+
+    status &= testCreate::test() && testCreate::failed();
+    std::cerr << "testCreate::test: " << status << std::endl;
+
+    status &= testThreads::test();
+    std::cerr << "testThreads::test: " << status << std::endl;
+
+    status &= testForked::test();
+    std::cerr << "testForked::test: " << status << std::endl;
+
+    status &= testNamed::test();
+    std::cerr << "testNamed::test: " << status << std::endl;
+
+    return status ? 0 : 1;
+}
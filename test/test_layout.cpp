@@ -0,0 +1,147 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <L3/static/disruptor.h>
+#include <L3/util/scopedtimer.h>
+
+#include <sys/resource.h>
+
+#include <array>
+#include <iostream>
+#include <thread>
+
+#ifndef L3_ITERATIONS
+#    define L3_ITERATIONS 10000000
+#endif 
+
+constexpr size_t iterations {L3_ITERATIONS};
+
+#ifndef L3_QSIZE
+#    define L3_QSIZE 19
+#endif
+
+using namespace std::chrono;
+using secs = duration<double>;
+//
+// A message of size bytes. Starts with a sequence number.
+//
+template<size_t size>
+struct Msg
+{
+    size_t sequence;
+    std::array<char, size - sizeof(size_t)> payload;
+};
+
+template<>
+struct Msg<sizeof(size_t)>
+{
+    size_t sequence;
+};
+//
+// Peak resident set. Kb on Linux, bytes on OS X. Rings are left in
+// BSS so the increase across a run is the memory the run touched.
+//
+inline long maxRSS()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+//
+// 1P1C throughput for one layout and message size.
+//
+template<size_t size, typename Layout, size_t tag>
+bool run(const char* name)
+{
+    using D = L3::Disruptor<Msg<size>, L3_QSIZE, L3::Tag<tag>, Layout>;
+    using Get = typename D::template Get<>;
+    using Put = typename D::template Put<>;
+
+    long rssBefore = maxRSS();
+    bool status = true;
+    L3::ScopedTimer<>::duration elapsed{0};
+    {
+        L3::ScopedTimer<> timer(elapsed);
+        std::thread producer(
+            []{
+                for(size_t i = 1; i < iterations; ++i)
+                {
+                    Put p;
+                    p->sequence = i;
+                }
+            });
+
+        size_t previous = 0;
+        for(size_t i = 1; i < iterations;)
+        {
+            for(auto& m: Get())
+            {
+                if(m.sequence != previous + 1)
+                {
+                    status = false;
+                }
+                previous = m.sequence;
+                ++i;
+            }
+        }
+        producer.join();
+    }
+    std::cout << name << " " << size << "B"
+              << ": slot: " << sizeof(typename D::Ring::value_type) << "B"
+              << ", ring: " << sizeof(typename D::Ring) / 1024 << "KB"
+              << ", rss: +" << maxRSS() - rssBefore
+              << ", throughput: "
+              << (iterations / duration_cast<secs>(elapsed).count()) /
+                 std::mega::num
+              << " M msgs/s"
+              << std::endl;
+    return status;
+}
+
+template<size_t size, size_t tag>
+bool runLayouts()
+{
+    using namespace L3::LayoutPolicy;
+    bool status = true;
+    status &= run<size, CacheLinePadded, tag>("CacheLinePadded");
+    status &= run<size, Packed, tag + 1>("Packed");
+    status &= run<size, Grouped<2>, tag + 2>("Grouped<2>");
+    return status;
+}
+
+int
+main()
+{
+    bool status = true;
+
+    status &= runLayouts<8, 800>();
+    std::cerr << "runLayouts<8>: " << status << std::endl;
+
+    status &= runLayouts<16, 810>();
+    std::cerr << "runLayouts<16>: " << status << std::endl;
+
+    status &= runLayouts<32, 820>();
+    std::cerr << "runLayouts<32>: " << status << std::endl;
+
+    return status ? 0 : 1;
+}
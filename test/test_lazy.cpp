@@ -0,0 +1,235 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <L3/static/consume.h>
+#include <L3/static/disruptor.h>
+#include <L3/static/get.h>
+#include <L3/static/spinpolicy.h>
+#include <L3/util/scopedtimer.h>
+
+#include <iostream>
+#include <thread>
+//
+// Small messages in small batches, where releasing the consumer's
+// cursor after every batch costs most. The producer puts one message
+// at a time and the consumer takes at most L3_BATCH at a time,
+// releasing its cursor eagerly after each or lazily.
+//
+#ifndef L3_ITERATIONS
+#    define L3_ITERATIONS 100000000
+#endif 
+
+constexpr size_t iterations {L3_ITERATIONS};
+
+#ifndef L3_QSIZE
+#    define L3_QSIZE 10
+#endif
+
+#ifndef L3_BATCH
+#    define L3_BATCH 4
+#endif
+
+using namespace std::chrono;
+using secs = duration<double>;
+using Spin = L3::SpinPolicy::Yield;
+using Msg = size_t;
+
+template<typename D, typename Get>
+void produce()
+{
+    using Put = typename D::template Put<L3::Barrier<Get>,
+                                         L3::CommitPolicy::Unique,
+                                         Spin>;
+    for(Msg i = 1; i <= iterations; ++i)
+    {
+        Put() = i;
+    }
+}
+//
+// Messages must arrive in order however the cursor is released.
+//
+template<typename Get>
+bool consume(size_t maxBatchSize)
+{
+    bool status = true;
+    Msg previous = 0;
+    while(previous != iterations)
+    {
+        for(Msg m: Get(maxBatchSize))
+        {
+            status &= m == previous + 1;
+            previous = m;
+        }
+    }
+    Get::flush();
+    return status;
+}
+//
+// Throughput in M msgs/s, or 0 if something went wrong.
+//
+template<typename D, typename Get>
+double run(size_t maxBatchSize = L3_BATCH)
+{
+    bool status = false;
+    L3::ScopedTimer<>::duration elapsed{0};
+    {
+        L3::ScopedTimer<> timer(elapsed);
+        std::thread c([&]{ status = consume<Get>(maxBatchSize); });
+        produce<D, Get>();
+        c.join();
+    }
+    if(!status || Get::cursor != D::size + iterations)
+    {
+        return 0;
+    }
+    return (iterations / duration_cast<secs>(elapsed).count()) /
+        std::mega::num;
+}
+
+namespace testEager
+{
+    using D = L3::Disruptor<Msg, L3_QSIZE, L3::Tag<2500>>;
+    using Get = D::Get<void, L3::Barrier<D>, Spin>;
+
+    bool test()
+    {
+        double throughput = run<D, Get>();
+        std::cout << "eager: throughput: " << throughput << " M msgs/s"
+                  << std::endl;
+        return throughput > 0;
+    }
+}
+
+namespace testLazy
+{
+    using D = L3::Disruptor<Msg, L3_QSIZE, L3::Tag<2510>>;
+    using Get = D::Get<void,
+                       L3::Barrier<D>,
+                       Spin,
+                       L3::PrefetchPolicy::None,
+                       L3::PublishPolicy::Lazy<>>;
+
+    bool test()
+    {
+        double throughput = run<D, Get>();
+        std::cout << "lazy: throughput: " << throughput << " M msgs/s"
+                  << std::endl;
+        return throughput > 0;
+    }
+}
+//
+// Releasing less often than the ring wraps. The producer only gets
+// slots back when the ring is full or the consumer runs dry.
+//
+namespace testWrap
+{
+    using D = L3::Disruptor<Msg, 4, L3::Tag<2520>>;
+    using Get = D::Get<void,
+                       L3::Barrier<D>,
+                       Spin,
+                       L3::PrefetchPolicy::None,
+                       L3::PublishPolicy::Lazy<1000, 100>>;
+
+    bool test() { return run<D, Get>(1) > 0; }
+}
+//
+// Fewer messages than it takes to release the cursor. They're only
+// released when the consumer finds nothing more to do.
+//
+namespace testIdle
+{
+    using D = L3::Disruptor<Msg, 8, L3::Tag<2530>>;
+    using Get = D::Get<void,
+                       L3::Barrier<D>,
+                       Spin,
+                       L3::PrefetchPolicy::None,
+                       L3::PublishPolicy::Lazy<64, 100>>;
+    using Put = D::Put<L3::Barrier<Get>>;
+
+    bool test()
+    {
+        for(Msg i = 1; i <= 3; ++i)
+        {
+            Put() = i;
+        }
+        bool status = true;
+        {
+            Get g;
+            status &= std::distance(g.begin(), g.end()) == 3;
+        }
+        status &= Get::cursor == D::size;
+        {
+            Get g(Get::noBlock);
+            status &= g.begin() == g.end();
+        }
+        return status && Get::cursor == D::size + 3;
+    }
+}
+//
+// consume() releases what's left on the way out.
+//
+namespace testConsume
+{
+    using D = L3::Disruptor<Msg, 8, L3::Tag<2540>>;
+    using Get = D::Get<void,
+                       L3::Barrier<D>,
+                       Spin,
+                       L3::PrefetchPolicy::None,
+                       L3::PublishPolicy::Lazy<64, 100>>;
+    using Put = D::Put<L3::Barrier<Get>>;
+
+    bool test()
+    {
+        for(Msg i = 1; i <= 5; ++i)
+        {
+            Put() = i;
+        }
+        size_t n = 0;
+        L3::CheckEOS<Msg, 5> eos(1);
+        L3::consume<Get>(eos, [&](Msg) { ++n; });
+        return n == 5 && Get::cursor == D::size + 5;
+    }
+}
+
+int
+main()
+{
+    bool status = true;
+
+    status &= testEager::test();
+    std::cerr << "testEager::test: " << status << std::endl;
+
+    status &= testLazy::test();
+    std::cerr << "testLazy::test: " << status << std::endl;
+
+    status &= testWrap::test();
+    std::cerr << "testWrap::test: " << status << std::endl;
+
+    status &= testIdle::test();
+    std::cerr << "testIdle::test: " << status << std::endl;
+
+    status &= testConsume::test();
+    std::cerr << "testConsume::test: " << status << std::endl;
+
+    return status ? 0 : 1;
+}
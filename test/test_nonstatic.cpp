@@ -0,0 +1,235 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <L3/non_static/disruptor.h>
+#include <L3/static/disruptor.h>
+#include <L3/static/spinpolicy.h>
+#include <L3/util/scopedtimer.h>
+
+#include <iostream>
+#include <thread>
+
+#ifndef L3_ITERATIONS
+#    define L3_ITERATIONS 10000000
+#endif 
+
+constexpr size_t iterations {L3_ITERATIONS};
+
+#ifndef L3_QSIZE
+#    define L3_QSIZE 17
+#endif
+
+using namespace std::chrono;
+using secs = duration<double>;
+
+using Msg = size_t;
+
+namespace NS = L3::NonStatic;
+
+template<typename Get, typename... Args>
+bool consume(Args&... args)
+{
+    bool status = true;
+    Msg previous = 0;
+    for(size_t i = 1; i < iterations;)
+    {
+        for(Msg m: Get(args...))
+        {
+            status &= m == previous + 1;
+            previous = m;
+            ++i;
+        }
+    }
+    return status;
+}
+
+void report(const char* name, L3::ScopedTimer<>::duration elapsed)
+{
+    std::cout << name << ": throughput: "
+              << (iterations / duration_cast<secs>(elapsed).count()) /
+                 std::mega::num
+              << " M msgs/s" << std::endl;
+}
+//
+// 1P1C static disruptor for comparison. Ring and cursors at fixed
+// addresses.
+//
+namespace testStatic
+{
+    using D = L3::Disruptor<Msg, L3_QSIZE, L3::Tag<1600>>;
+    using Get = D::Get<>;
+    using Put = D::Put<>;
+
+    bool test()
+    {
+        bool status;
+        L3::ScopedTimer<>::duration elapsed{0};
+        {
+            L3::ScopedTimer<> timer(elapsed);
+            std::thread producer(
+                []{
+                    for(Msg i = 1; i < iterations; ++i)
+                    {
+                        Put() = i;
+                    }
+                });
+            status = consume<Get>();
+            producer.join();
+        }
+        report("static", elapsed);
+        return status;
+    }
+}
+//
+// Same again with the disruptor made at runtime.
+//
+namespace testRuntime
+{
+    using Consumer = NS::Consumer<Msg>;
+    using Producer = NS::Producer<Msg>;
+
+    bool test(const char* name, L3::Memory::Backing backing)
+    {
+        NS::Disruptor<Msg> d(L3_QSIZE, 1, backing);
+        Consumer consumer(d, NS::Barrier(d));
+        Producer producer(d, NS::Barrier(consumer));
+
+        bool status;
+        L3::ScopedTimer<>::duration elapsed{0};
+        {
+            L3::ScopedTimer<> timer(elapsed);
+            std::thread thread(
+                [&]{
+                    for(Msg i = 1; i < iterations; ++i)
+                    {
+                        Producer::Put{producer} = i;
+                    }
+                });
+            status = consume<Consumer::Get>(consumer);
+            thread.join();
+        }
+        report(name, elapsed);
+        return status;
+    }
+}
+//
+// Producer into two consumers in parallel into a third. Size from
+// "config". Yield so as not to depend on having a core per thread.
+//
+namespace test1to2to1
+{
+    using Spin = L3::SpinPolicy::Yield;
+    using Consumer = NS::Consumer<Msg, Spin>;
+    using Producer = NS::Producer<Msg, NS::CommitPolicy::Unique, Spin>;
+
+    bool test(size_t log2size)
+    {
+        NS::Disruptor<Msg> d(log2size, 3);
+        Consumer c1(d, NS::Barrier(d));
+        Consumer c2(d, NS::Barrier(d));
+        Consumer c3(d, NS::Barrier(c1, c2));
+        Producer producer(d, NS::Barrier(c3));
+
+        bool status1;
+        bool status2;
+        std::thread t1([&]{ status1 = consume<Consumer::Get>(c1); });
+        std::thread t2([&]{ status2 = consume<Consumer::Get>(c2); });
+        std::thread t3(
+            [&]{
+                for(Msg i = 1; i < iterations; ++i)
+                {
+                    Producer::Put{producer} = i;
+                }
+            });
+        bool status3 = consume<Consumer::Get>(c3);
+        t1.join();
+        t2.join();
+        t3.join();
+        return status1 && status2 && status3;
+    }
+}
+//
+// Two producers sharing a disruptor.
+//
+namespace test2to1
+{
+    using Spin = L3::SpinPolicy::Yield;
+    using Consumer = NS::Consumer<Msg, Spin>;
+    using Producer = NS::Producer<Msg, NS::CommitPolicy::Shared, Spin>;
+
+    bool test()
+    {
+        NS::Disruptor<Msg> d(L3_QSIZE, 1);
+        Consumer consumer(d, NS::Barrier(d));
+
+        auto produce = [&](Msg first){
+            Producer producer(d, NS::Barrier(consumer));
+            for(Msg i = first; i < iterations; i += 2)
+            {
+                Producer::Put{producer} = i;
+            }
+        };
+        std::thread p1(produce, 1);
+        std::thread p2(produce, 2);
+
+        bool status = true;
+        Msg previous[2] = {0, 0};
+        for(size_t i = 1; i < iterations;)
+        {
+            for(Msg m: Consumer::Get(consumer))
+            {
+                Msg& prev = previous[m & 1];
+                status &= prev == 0 ? m <= 2 : m == prev + 2;
+                prev = m;
+                ++i;
+            }
+        }
+        p1.join();
+        p2.join();
+        return status;
+    }
+}
+
+int
+main()
+{
+    bool status = true;
+
+    status &= testStatic::test();
+    std::cerr << "testStatic::test: " << status << std::endl;
+
+    status &= testRuntime::test("runtime heap", L3::Memory::heap);
+    std::cerr << "testRuntime::test heap: " << status << std::endl;
+
+    status &= testRuntime::test("runtime mmap", L3::Memory::anonymous);
+    std::cerr << "testRuntime::test anonymous: " << status << std::endl;
+
+    status &= test1to2to1::test(10);
+    std::cerr << "test1to2to1::test: " << status << std::endl;
+
+    status &= test2to1::test();
+    std::cerr << "test2to1::test: " << status << std::endl;
+
+    return status ? 0 : 1;
+}
@@ -0,0 +1,218 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <L3/static/disruptor.h>
+#include <L3/static/replicator.h>
+#include <L3/static/spinpolicy.h>
+#include <L3/static/warm.h>
+#include <L3/util/memory.h>
+#include <L3/util/numa.h>
+#include <L3/util/scopedtimer.h>
+
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <vector>
+//
+// NUMA placement and replication. Placement can only be checked
+// properly on a machine with more than one node. Elsewhere we check
+// it degrades to doing nothing without failing.
+//
+#ifndef L3_ITERATIONS
+#    define L3_ITERATIONS 10000000
+#endif 
+
+constexpr size_t iterations {L3_ITERATIONS};
+
+#ifndef L3_QSIZE
+#    define L3_QSIZE 17
+#endif
+
+using namespace std::chrono;
+using secs = duration<double>;
+
+namespace testTopology
+{
+    bool test()
+    {
+        using namespace L3::Numa;
+
+        bool status = true;
+        status &= parseList("0-3,8,10-11") ==
+            std::vector<int>({0, 1, 2, 3, 8, 10, 11});
+        status &= parseList("5") == std::vector<int>({5});
+
+        int n = nodes();
+        status &= n >= 1;
+        status &= currentNode() < n;
+        status &= nodeOf(0) < n;
+        status &= cpus(n).empty();
+
+        std::cout << "nodes: " << n << ", current: " << currentNode()
+                  << std::endl;
+        return status;
+    }
+}
+
+namespace testBind
+{
+    using namespace L3;
+
+    bool test()
+    {
+        bool status = true;
+        int last = Numa::nodes() - 1;
+        //
+        // Placed memory is still zeroed and usable wherever it ends
+        // up.
+        //
+        for(auto backing: {Memory::heap, Memory::anonymous, Memory::shared})
+        {
+            Memory m(1 << 20, backing, Memory::prefault, last);
+            const char* p = static_cast<const char*>(m.data());
+            status &= std::all_of(p,
+                                  p + m.size(),
+                                  [](char c){ return c == 0; });
+        }
+        status &= Numa::bind(nullptr, 0, Numa::anyNode);
+        //
+        // There's no node past the last.
+        //
+        char buf[4096];
+        status &= !Numa::bind(buf, sizeof(buf), last + 1);
+        {
+            Numa::Preferred preferred(last);
+            std::vector<char> v(1 << 20, 1);
+            status &= v.back() == 1;
+        }
+        status &= Numa::runOn(last);
+        return status;
+    }
+}
+
+namespace testReplicator
+{
+    using Spin = L3::SpinPolicy::Yield;
+    //
+    // The source ring with its local consumer and the replicator's
+    // Get. Its producer gates on both.
+    //
+    using Source = L3::Disruptor<size_t, L3_QSIZE, L3::Tag<1800>>;
+    using SourceGet = Source::Get<void, L3::Barrier<Source>, Spin>;
+    using CopyGet = Source::Get<L3::Tag<1801>, L3::Barrier<Source>, Spin>;
+    using SourcePut = Source::Put<L3::Barrier<SourceGet, CopyGet>,
+                                  L3::CommitPolicy::Unique,
+                                  Spin>;
+    //
+    // The replica for consumers on the other node.
+    //
+    using Remote = L3::Disruptor<size_t, L3_QSIZE, L3::Tag<1810>>;
+    using RemoteGet = Remote::Get<void, L3::Barrier<Remote>, Spin>;
+    using RemotePut = Remote::Put<L3::Barrier<RemoteGet>,
+                                  L3::CommitPolicy::Unique,
+                                  Spin>;
+
+    using Copy = L3::Replicator<CopyGet, RemotePut>;
+    //
+    // Read 1..iterations then the end of stream marker.
+    //
+    template<typename Get>
+    bool consume()
+    {
+        size_t expected = 1;
+        for(;;)
+        {
+            for(auto m: Get())
+            {
+                if(m == 0)
+                {
+                    return expected == iterations + 1;
+                }
+                if(m != expected++)
+                {
+                    return false;
+                }
+            }
+        }
+    }
+
+    bool test()
+    {
+        int remote = L3::Numa::nodes() - 1;
+        L3::warm<Remote>(L3::Memory::prefault, remote);
+
+        bool localStatus = false;
+        bool remoteStatus = false;
+        L3::ScopedTimer<>::duration elapsed{0};
+        {
+            L3::ScopedTimer<> timer(elapsed);
+            std::thread local([&]{ localStatus = consume<SourceGet>(); });
+            std::thread replica(
+                [&]{
+                    L3::Numa::runOn(remote);
+                    remoteStatus = consume<RemoteGet>();
+                });
+            std::thread copy(
+                [&]{
+                    L3::Numa::runOn(remote);
+                    Copy::run([](size_t m){ return m == 0; });
+                });
+
+            for(size_t i = 1; i <= iterations; ++i)
+            {
+                SourcePut() = i;
+            }
+            SourcePut() = 0;
+
+            local.join();
+            copy.join();
+            replica.join();
+        }
+        std::cout << "replicated: throughput: "
+                  << (iterations / duration_cast<secs>(elapsed).count()) /
+            std::mega::num
+                  << " M msgs/s" << std::endl;
+        //
+        // Nothing left behind.
+        //
+        return localStatus && remoteStatus && Copy::poll() == 0;
+    }
+}
+
+int
+main()
+{
+    bool status = true;
+
+    status &= testTopology::test();
+    std::cerr << "testTopology::test: " << status << std::endl;
+
+    status &= testBind::test();
+    std::cerr << "testBind::test: " << status << std::endl;
+
+    status &= testReplicator::test();
+    std::cerr << "testReplicator::test: " << status << std::endl;
+
+    return status ? 0 : 1;
+}
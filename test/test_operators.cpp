@@ -0,0 +1,268 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <L3/static/consume.h>
+#include <L3/static/disruptor.h>
+#include <L3/static/operators.h>
+#include <L3/static/processor.h>
+#include <L3/static/spinpolicy.h>
+#include <L3/util/scopedtimer.h>
+
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+//
+// Operators on their own, then a map, filter and scan fused into
+// one consumer against the same three as a chain of disruptors.
+//
+#ifndef L3_ITERATIONS
+#    define L3_ITERATIONS 10000000
+#endif 
+
+constexpr size_t iterations {L3_ITERATIONS};
+
+#ifndef L3_QSIZE
+#    define L3_QSIZE 17
+#endif
+
+using namespace std::chrono;
+using secs = duration<double>;
+using namespace L3::Op;
+using Spin = L3::SpinPolicy::Yield;
+
+namespace testOperators
+{
+    //
+    // Push values through a handler a batch at a time.
+    //
+    template<typename Handler>
+    void feed(Handler& h, const std::vector<std::vector<int>>& batches)
+    {
+        for(auto& batch: batches)
+        {
+            for(int i: batch)
+            {
+                h(i);
+            }
+            L3::endOfBatch(h);
+        }
+    }
+
+    bool test()
+    {
+        bool status = true;
+        std::vector<std::vector<int>> batches{{1, 2, 3}, {4, 5}, {}, {6}};
+        std::vector<int> out;
+        auto collect = [&](int i){ out.push_back(i); };
+
+        auto mapped = map([](int i){ return i * 10; }) | collect;
+        feed(mapped, batches);
+        status &= out == std::vector<int>({10, 20, 30, 40, 50, 60});
+
+        out.clear();
+        auto odd = filter([](int i){ return i % 2; }) | collect;
+        feed(odd, batches);
+        status &= out == std::vector<int>({1, 3, 5});
+
+        out.clear();
+        auto sums = scan(0, std::plus<int>()) | collect;
+        feed(sums, batches);
+        status &= out == std::vector<int>({1, 3, 6, 10, 15, 21});
+
+        out.clear();
+        auto pairs = tumbling(2, 0, std::plus<int>()) | collect;
+        feed(pairs, batches);
+        status &= out == std::vector<int>({3, 7, 11});
+        try
+        {
+            tumbling(0, 0, std::plus<int>());
+            status = false;
+        }
+        catch(const std::invalid_argument&)
+        {
+        }
+
+        out.clear();
+        auto spread = sliding<int, 3>()
+            | map([](const Window<int, 3>& w){ return w.back() - w.front(); })
+            | collect;
+        feed(spread, batches);
+        status &= out == std::vector<int>({2, 2, 2, 2});
+
+        out.clear();
+        auto perBatch = aggregate(0, std::plus<int>()) | collect;
+        feed(perBatch, batches);
+        status &= out == std::vector<int>({6, 9, 6});
+        //
+        // All together.
+        //
+        out.clear();
+        auto fused = map([](int i){ return i * i; })
+            | filter([](int i){ return i > 1; })
+            | scan(0, std::plus<int>())
+            | aggregate(0, [](int, int i){ return i; })
+            | collect;
+        feed(fused, batches);
+        status &= out == std::vector<int>({13, 54, 90});
+
+        return status;
+    }
+}
+//
+// The work each version does: triple, keep the even ones and keep a
+// running total. Messages are 1 to iterations.
+//
+namespace
+{
+    struct Triple
+    {
+        size_t operator()(size_t i) const { return i * 3; }
+    };
+
+    struct Even
+    {
+        bool operator()(size_t i) const { return i % 2 == 0; }
+    };
+
+    size_t total;
+
+    struct Store
+    {
+        void operator()(size_t i) const { total = i; }
+    };
+
+    constexpr size_t expected()
+    {
+        return 3 * (iterations / 2) * (iterations / 2 + 1);
+    }
+
+    template<typename Put>
+    void produce()
+    {
+        for(size_t i = 1; i <= iterations; ++i)
+        {
+            Put() = i;
+        }
+    }
+
+    template<typename Put>
+    struct Forward
+    {
+        void operator()(size_t i) const { Put() = i; }
+    };
+
+    void report(const char* name, L3::ScopedTimer<>::duration elapsed)
+    {
+        std::cout << name << ": throughput: "
+                  << (iterations / duration_cast<secs>(elapsed).count()) /
+            std::mega::num
+                  << " M msgs/s" << std::endl;
+    }
+}
+
+namespace testFused
+{
+    using D = L3::Disruptor<size_t, L3_QSIZE, L3::Tag<2300>>;
+    using Get = D::Get<>;
+    using Put = D::Put<L3::Barrier<Get>, L3::CommitPolicy::Unique, Spin>;
+
+    bool test()
+    {
+        total = 0;
+        L3::ScopedTimer<>::duration elapsed{0};
+        {
+            L3::ScopedTimer<> timer(elapsed);
+            auto c = L3::makeProcessor<Get, Spin>(
+                map(Triple()) |
+                filter(Even()) |
+                scan(size_t(0), std::plus<size_t>()) |
+                Store());
+            c->start();
+            produce<Put>();
+            c->halt();
+        }
+        report("fused", elapsed);
+        return total == expected();
+    }
+}
+
+namespace testChained
+{
+    //
+    // D1 - map - D2 - filter - D3 - scan
+    //
+    template<size_t tag>
+    struct Hop
+    {
+        using D = L3::Disruptor<size_t, L3_QSIZE, L3::Tag<tag>>;
+        using Get = typename D::template Get<>;
+        using Put = typename D::template Put<L3::Barrier<Get>,
+                                             L3::CommitPolicy::Unique,
+                                             Spin>;
+    };
+    using D1 = Hop<2310>;
+    using D2 = Hop<2311>;
+    using D3 = Hop<2312>;
+
+    bool test()
+    {
+        total = 0;
+        L3::ScopedTimer<>::duration elapsed{0};
+        {
+            L3::ScopedTimer<> timer(elapsed);
+            auto c1 = L3::makeProcessor<D1::Get, Spin>(
+                map(Triple()) | Forward<D2::Put>());
+            auto c2 = L3::makeProcessor<D2::Get, Spin>(
+                filter(Even()) | Forward<D3::Put>());
+            auto c3 = L3::makeProcessor<D3::Get, Spin>(
+                scan(size_t(0), std::plus<size_t>()) | Store());
+
+            L3::Group group;
+            group.add(*c1).add(*c2).add(*c3);
+            group.start();
+            produce<D1::Put>();
+            group.halt();
+        }
+        report("chained", elapsed);
+        return total == expected();
+    }
+}
+
+int
+main()
+{
+    bool status = true;
+
+    status &= testOperators::test();
+    std::cerr << "testOperators::test: " << status << std::endl;
+
+    status &= testFused::test();
+    std::cerr << "testFused::test: " << status << std::endl;
+
+    status &= testChained::test();
+    std::cerr << "testChained::test: " << status << std::endl;
+
+    return status ? 0 : 1;
+}
@@ -0,0 +1,139 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <L3/static/disruptor.h>
+#include <L3/static/spinpolicy.h>
+
+#include <time.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <vector>
+//
+// Consumer CPU use and latency under bursty load for the different
+// spin policies. The producer sends bursts of messages separated by
+// gaps, some short enough that spinning pays and some long enough
+// that it doesn't.
+//
+#ifndef L3_ITERATIONS
+#    define L3_ITERATIONS 100000
+#endif 
+
+constexpr size_t iterations {L3_ITERATIONS};
+constexpr size_t burst = 100;
+
+using namespace std::chrono;
+using Clock = steady_clock;
+
+inline nanoseconds threadTime()
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return seconds(ts.tv_sec) + nanoseconds(ts.tv_nsec);
+}
+//
+// Gap after each burst. Mostly short with every tenth long.
+//
+inline microseconds gap(size_t burstNo)
+{
+    return burstNo % 10 == 9 ? microseconds(2000) : microseconds(20);
+}
+
+template<typename SpinPolicy, size_t tag>
+bool run(const char* name)
+{
+    using D = L3::Disruptor<Clock::time_point, 12, L3::Tag<tag>>;
+    using Get = typename D::template Get<void, L3::Barrier<D>, SpinPolicy>;
+    using Put = typename D::template Put<L3::Barrier<Get>,
+                                         L3::CommitPolicy::Unique,
+                                         SpinPolicy>;
+
+    std::vector<Clock::duration> latencies;
+    latencies.reserve(iterations);
+    nanoseconds cpu;
+    Clock::duration elapsed;
+
+    std::thread consumer(
+        [&]{
+            nanoseconds start = threadTime();
+            while(latencies.size() < iterations)
+            {
+                for(auto& sent: Get())
+                {
+                    latencies.push_back(Clock::now() - sent);
+                }
+            }
+            cpu = threadTime() - start;
+        });
+
+    Clock::time_point start = Clock::now();
+    for(size_t i = 0; i < iterations; ++i)
+    {
+        Put() = Clock::now();
+        if(i % burst == burst - 1)
+        {
+            std::this_thread::sleep_for(gap(i / burst));
+        }
+    }
+    consumer.join();
+    elapsed = Clock::now() - start;
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p)
+    {
+        return duration_cast<nanoseconds>(
+            latencies[size_t(p * (iterations - 1))]).count();
+    };
+    std::cout << name
+              << ": consumer cpu: "
+              << 100 * cpu.count() / duration_cast<nanoseconds>(elapsed).count()
+              << "%, p50: " << percentile(0.5) << "ns"
+              << ", p99: " << percentile(0.99) << "ns"
+              << ", p99.9: " << percentile(0.999) << "ns"
+              << std::endl;
+    return latencies.size() == iterations;
+}
+
+int
+main()
+{
+    using namespace L3::SpinPolicy;
+    bool status = true;
+
+    status &= run<L3::NoOp, 1500>("NoOp");
+    std::cerr << "NoOp: " << status << std::endl;
+
+    status &= run<Yield, 1510>("Yield");
+    std::cerr << "Yield: " << status << std::endl;
+
+    status &= run<Block<>, 1520>("Block");
+    std::cerr << "Block: " << status << std::endl;
+
+    status &= run<Phased<>, 1530>("Phased");
+    std::cerr << "Phased: " << status << std::endl;
+
+    return status ? 0 : 1;
+}
@@ -0,0 +1,193 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <L3/static/disruptor.h>
+#include <L3/static/pipeline.h>
+#include <L3/static/spinpolicy.h>
+
+#include <iostream>
+#include <thread>
+#include <type_traits>
+//
+// Pipelines derive the barriers we'd otherwise write by hand, then
+// run.
+//
+#ifndef L3_ITERATIONS
+#    define L3_ITERATIONS 10000000
+#endif 
+
+constexpr size_t iterations {L3_ITERATIONS};
+
+#ifndef L3_QSIZE
+#    define L3_QSIZE 17
+#endif
+
+using Msg = size_t;
+using L3::After;
+using L3::Stage;
+//
+// Handlers count what they see and check each producer's messages
+// arrive in order. Producer p sends p, p + producers, ...
+//
+template<size_t id, size_t producers = 2>
+struct Check
+{
+    static size_t count;
+    static bool status;
+    static Msg previous[producers];
+
+    void operator()(Msg m)
+    {
+        Msg& prev = previous[m % producers];
+        status &= prev == 0 ? m == m % producers + producers
+                            : m == prev + producers;
+        prev = m;
+        ++count;
+    }
+};
+
+template<size_t id, size_t producers>
+size_t Check<id, producers>::count{0};
+template<size_t id, size_t producers>
+bool Check<id, producers>::status{true};
+template<size_t id, size_t producers>
+Msg Check<id, producers>::previous[producers];
+
+using C1 = Check<1>;
+using C2 = Check<2>;
+using C3 = Check<3>;
+using C4 = Check<4>;
+
+namespace testBarriers
+{
+    using D = L3::Disruptor<Msg, 10, L3::Tag<2100>>;
+
+    template<typename P, typename Handler, typename... Follows>
+    using Gated = std::is_same<
+        typename P::template Get<Handler>,
+        typename D::template Get<Handler, L3::Barrier<Follows...>>>;
+
+    template<typename P, typename Commit, typename... Follows>
+    using PutGated = std::is_same<
+        typename P::Put,
+        typename D::template Put<L3::Barrier<Follows...>, Commit>>;
+    //
+    // The topology from examples/complex.cpp.
+    //
+    using Complex = L3::Pipeline<D, 2,
+                                 Stage<C1>,
+                                 Stage<C2>,
+                                 Stage<C3, After<C1, C2>>>;
+    static_assert(Gated<Complex, C1, D>::value, "");
+    static_assert(Gated<Complex, C2, D>::value, "");
+    static_assert(
+        Gated<Complex, C3, Complex::Get<C1>, Complex::Get<C2>>::value, "");
+    static_assert(
+        PutGated<Complex,
+                 L3::CommitPolicy::Shared,
+                 Complex::Get<C3>>::value, "");
+    //
+    // A chain. Listing every upstream stage costs nothing: C3 only
+    // needs C2 and the producer only the last stage.
+    //
+    using Chain = L3::Pipeline<D, 1,
+                               Stage<C1>,
+                               Stage<C2, After<C1>>,
+                               Stage<C3, After<C1, C2, C2>>>;
+    static_assert(Gated<Chain, C2, Chain::Get<C1>>::value, "");
+    static_assert(Gated<Chain, C3, Chain::Get<C2>>::value, "");
+    static_assert(
+        PutGated<Chain, L3::CommitPolicy::Unique, Chain::Get<C3>>::value,
+        "");
+    //
+    // A diamond with a shortcut and a second sink.
+    //
+    using Diamond = L3::Pipeline<D, 1,
+                                 Stage<C1>,
+                                 Stage<C2, After<C1>>,
+                                 Stage<C3, After<C1>>,
+                                 Stage<C4, After<C1, C2, C3>>,
+                                 Stage<Check<5>, After<C1>>>;
+    static_assert(
+        Gated<Diamond, C4, Diamond::Get<C2>, Diamond::Get<C3>>::value, "");
+    static_assert(
+        PutGated<Diamond,
+                 L3::CommitPolicy::Unique,
+                 Diamond::Get<C4>,
+                 Diamond::Get<Check<5>>>::value, "");
+
+    bool test() { return true; }
+}
+
+namespace testRun
+{
+    using D = L3::Disruptor<Msg, L3_QSIZE, L3::Tag<2110>>;
+    using P = L3::Pipeline<D, 2,
+                           Stage<C1>,
+                           Stage<C2>,
+                           Stage<C3, After<C1, C2>>,
+                           Stage<C4, After<C3>>>;
+    using Spin = L3::SpinPolicy::Yield;
+    using Put = P::PutWith<Spin, Spin>;
+
+    void produce(Msg first)
+    {
+        for(Msg i = first; i <= iterations; i += 2)
+        {
+            Put() = i;
+        }
+    }
+
+    bool test()
+    {
+        P::Threads<Spin> threads;
+        threads.start();
+
+        std::thread p1(produce, 3);
+        std::thread p2(produce, 2);
+        p1.join();
+        p2.join();
+        threads.halt();
+
+        const size_t n = iterations - 1;
+        return C1::status && C1::count == n &&
+            C2::status && C2::count == n &&
+            C3::status && C3::count == n &&
+            C4::status && C4::count == n;
+    }
+}
+
+int
+main()
+{
+    bool status = true;
+
+    status &= testBarriers::test();
+    std::cerr << "testBarriers::test: " << status << std::endl;
+
+    status &= testRun::test();
+    std::cerr << "testRun::test: " << status << std::endl;
+
+    return status ? 0 : 1;
+}
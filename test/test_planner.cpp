@@ -0,0 +1,290 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <L3/static/disruptor.h>
+#include <L3/static/planner.h>
+#include <L3/util/topology.h>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+//
+// Thread placement over a made up two socket machine so results
+// don't depend on where the test runs. Each socket has two cores
+// with two hardware threads each. CPU numbering follows Linux, so
+// cpu n and cpu n + 4 are SMT siblings.
+//
+namespace
+{
+    void write(const std::string& path, const std::string& value)
+    {
+        std::ofstream(path) << value << std::endl;
+    }
+
+    void mkdirs(const std::string& path)
+    {
+        for(size_t pos = 1; (pos = path.find('/', pos)) != std::string::npos;
+            ++pos)
+        {
+            mkdir(path.substr(0, pos).c_str(), 0700);
+        }
+        mkdir(path.c_str(), 0700);
+    }
+
+    std::string fakeSysfs()
+    {
+        char root[] = "/tmp/l3_topology_XXXXXX";
+        std::string result = mkdtemp(root);
+        write(result + "/online", "0-7");
+        for(int id = 0; id < 8; ++id)
+        {
+            int package = id / 2 % 2;
+            int core = id % 2;
+            int first = package * 2 + core;
+            std::string cpu = result + "/cpu" + std::to_string(id);
+            mkdirs(cpu + "/topology");
+            mkdirs(cpu + "/node" + std::to_string(package));
+            write(cpu + "/topology/physical_package_id",
+                  std::to_string(package));
+            write(cpu + "/topology/core_id", std::to_string(core));
+
+            std::string siblings = std::to_string(first) + "," +
+                std::to_string(first + 4);
+            std::string socket = std::to_string(package * 2) + "-" +
+                std::to_string(package * 2 + 1) + "," +
+                std::to_string(package * 2 + 4) + "-" +
+                std::to_string(package * 2 + 5);
+            const char* types[] = {
+                "Data", "Instruction", "Unified", "Unified"
+            };
+            const int levels[] = { 1, 1, 2, 3 };
+            for(int i = 0; i < 4; ++i)
+            {
+                std::string index = cpu + "/cache/index" + std::to_string(i);
+                mkdirs(index);
+                write(index + "/type", types[i]);
+                write(index + "/level", std::to_string(levels[i]));
+                write(index + "/shared_cpu_list", i < 3 ? siblings : socket);
+            }
+        }
+        return result;
+    }
+
+    const std::string root = fakeSysfs();
+}
+
+namespace testTopology
+{
+    using L3::Topology;
+
+    bool test()
+    {
+        Topology topology(root);
+        bool status = topology.known() && topology.cpus().size() == 8;
+
+        const Topology::Cpu& c0 = *topology.cpu(0);
+        status &= Topology::distance(c0, *topology.cpu(0)) == Topology::same;
+        status &= Topology::distance(c0, *topology.cpu(4)) == Topology::smt;
+        status &= Topology::distance(c0, *topology.cpu(1)) == Topology::l3;
+        status &= Topology::distance(c0, *topology.cpu(2)) == Topology::remote;
+        status &= topology.cpu(6)->node == 1;
+        //
+        // Every core before any sibling, sockets kept together.
+        //
+        std::vector<int> expected{0, 1, 2, 3, 4, 5, 6, 7};
+        std::vector<int> ordered;
+        for(auto& c: topology.ordered())
+        {
+            ordered.push_back(c.id);
+        }
+        status &= ordered == expected;
+        //
+        // With nothing to read we still have CPUs to place on.
+        //
+        Topology none(root + "/missing");
+        status &= !none.known() && !none.cpus().empty();
+        //
+        // The machine we're on.
+        //
+        Topology here;
+        std::cout << "cpus: " << here.cpus().size()
+                  << ", known: " << here.known() << std::endl;
+        return status;
+    }
+}
+
+namespace testPairs
+{
+    //
+    // Two independent producer consumer pairs. Each pair should share
+    // a socket.
+    //
+    using D1 = L3::Disruptor<size_t, 10, L3::Tag<2000>>;
+    using D2 = L3::Disruptor<size_t, 10, L3::Tag<2001>>;
+
+    bool test()
+    {
+        L3::Planner planner;
+        planner.thread<D1::Put<>>("P1")
+               .thread<D2::Put<>>("P2")
+               .thread<D1::Get<>>("C1")
+               .thread<D2::Get<>>("C2");
+        L3::Topology topology(root);
+        L3::Plan plan = planner.plan(topology);
+        std::cout << plan;
+
+        auto cpu = [&](const char* t){ return *topology.cpu(plan.cpu(t)); };
+        return planner.weight(0, 2) == 2 &&
+            planner.weight(0, 1) == 0 &&
+            L3::Topology::distance(cpu("P1"), cpu("C1")) ==
+            L3::Topology::l3 &&
+            L3::Topology::distance(cpu("P2"), cpu("C2")) ==
+            L3::Topology::l3;
+    }
+}
+
+namespace testComplex
+{
+    //
+    // The topology from examples/complex.cpp.
+    //
+    using D1 = L3::Disruptor<size_t, 10, L3::Tag<2010>>;
+    using Get1 = D1::Get<L3::Tag<1>>;
+    using Get2 = D1::Get<L3::Tag<2>>;
+    using Get3 = D1::Get<L3::Tag<3>, L3::Barrier<Get1, Get2>>;
+    using Put1 = D1::Put<L3::Barrier<Get3>, L3::CommitPolicy::Shared>;
+    using D2 = L3::Disruptor<size_t, 10, L3::Tag<2011>>;
+    using Get4 = D2::Get<>;
+    using Put2 = D2::Put<>;
+
+    bool test()
+    {
+        L3::Planner planner;
+        planner.thread<Put1>("P1")
+               .thread<Put1>("P2")
+               .thread<Get1>("C1")
+               .thread<Get2>("C2")
+               .thread<Get3, Put2>("C3")
+               .thread<Get4>("C4");
+        bool status = true;
+        //
+        // Shared producers contend on both the claim and commit
+        // cursors. The bridge C3 talks to C4 both ways.
+        //
+        status &= planner.weight(0, 1) == 2;
+        status &= planner.weight(4, 5) == 2;
+        status &= planner.weight(2, 4) == 1;
+
+        L3::Topology topology(root);
+        L3::Plan plan = planner.plan(topology);
+        std::cout << plan;
+        //
+        // Every thread has its own CPU, C3 and C4 share a socket and
+        // the plan is no worse than laying threads out in order.
+        //
+        std::vector<int> cpus;
+        for(auto& a: plan.assignments())
+        {
+            cpus.push_back(a.cpu);
+        }
+        std::sort(cpus.begin(), cpus.end());
+        status &= std::unique(cpus.begin(), cpus.end()) == cpus.end();
+        status &= L3::Topology::distance(
+            *topology.cpu(plan.cpu("C3")),
+            *topology.cpu(plan.cpu("C4"))) <= L3::Topology::l3;
+
+        std::vector<L3::Topology::Cpu> ordered = topology.ordered();
+        std::vector<size_t> slots, inOrder;
+        for(auto& a: plan.assignments())
+        {
+            for(size_t i = 0; i < ordered.size(); ++i)
+            {
+                if(ordered[i].id == a.cpu)
+                {
+                    slots.push_back(i);
+                }
+            }
+            inOrder.push_back(inOrder.size());
+        }
+        status &= planner.cost(slots, ordered) <=
+            planner.cost(inOrder, ordered);
+        //
+        // More threads than CPUs goes round robin.
+        //
+        L3::Plan tight = planner.plan(L3::Topology(root + "/missing"));
+        status &= tight.assignments().size() == 6;
+
+        status &= plan.options("C1").cpu == plan.cpu("C1");
+        return status;
+    }
+}
+
+//
+// Shared producers committing through an AvailabilityBuffer link to
+// consumers gating on it.
+//
+namespace testAvailable
+{
+    using D = L3::Disruptor<size_t, 10, L3::Tag<2020>>;
+    using Get = D::Get<void, L3::Barrier<L3::AvailabilityBuffer<D>>>;
+    using Put = D::Put<L3::Barrier<Get>, L3::CommitPolicy::Available>;
+
+    bool test()
+    {
+        L3::Planner planner;
+        planner.thread<Put>("P1")
+               .thread<Put>("P2")
+               .thread<Get>("C1");
+        return planner.weight(0, 1) == 2 &&
+            planner.weight(0, 2) == 2 &&
+            planner.weight(1, 2) == 2;
+    }
+}
+
+int
+main()
+{
+    bool status = true;
+
+    status &= testTopology::test();
+    std::cerr << "testTopology::test: " << status << std::endl;
+
+    status &= testPairs::test();
+    std::cerr << "testPairs::test: " << status << std::endl;
+
+    status &= testComplex::test();
+    std::cerr << "testComplex::test: " << status << std::endl;
+
+    status &= testAvailable::test();
+    std::cerr << "testAvailable::test: " << status << std::endl;
+
+    std::system(("rm -r " + root).c_str());
+
+    return status ? 0 : 1;
+}
@@ -0,0 +1,138 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <L3/static/disruptor.h>
+#include <L3/util/scopedtimer.h>
+
+#include <array>
+#include <iostream>
+#include <thread>
+
+#ifndef L3_ITERATIONS
+#    define L3_ITERATIONS 10000000
+#endif 
+
+constexpr size_t iterations {L3_ITERATIONS};
+//
+// Big enough that the ring doesn't fit in cache.
+//
+#ifndef L3_QSIZE
+#    define L3_QSIZE 16
+#endif
+
+using namespace std::chrono;
+using secs = duration<double>;
+//
+// A message of size bytes. The consumer reads all of it so is bound
+// by memory rather than by what it does with the message.
+//
+template<size_t size>
+struct Msg
+{
+    size_t sequence;
+    std::array<size_t, size / sizeof(size_t) - 1> payload;
+};
+//
+// 1P1C throughput reading every byte of each message.
+//
+template<size_t size, typename Prefetch, size_t tag>
+bool run(const char* name)
+{
+    using D = L3::Disruptor<Msg<size>,
+                            L3_QSIZE,
+                            L3::Tag<tag>,
+                            L3::LayoutPolicy::Packed>;
+    using Get = typename D::template Get<void,
+                                         L3::Barrier<D>,
+                                         L3::NoOp,
+                                         Prefetch>;
+    using Put = typename D::template Put<L3::Barrier<Get>>;
+
+    bool status = true;
+    size_t sum = 0;
+    L3::ScopedTimer<>::duration elapsed{0};
+    {
+        L3::ScopedTimer<> timer(elapsed);
+        std::thread producer(
+            []{
+                for(size_t i = 1; i < iterations; ++i)
+                {
+                    Put p;
+                    p->sequence = i;
+                    p->payload.fill(i);
+                }
+            });
+
+        size_t previous = 0;
+        for(size_t i = 1; i < iterations;)
+        {
+            for(auto& m: Get())
+            {
+                if(m.sequence != previous + 1)
+                {
+                    status = false;
+                }
+                previous = m.sequence;
+                for(auto p: m.payload)
+                {
+                    sum += p;
+                }
+                ++i;
+            }
+        }
+        producer.join();
+    }
+    std::cout << name << " " << size << "B"
+              << ": throughput: "
+              << (iterations / duration_cast<secs>(elapsed).count()) /
+                 std::mega::num
+              << " M msgs/s, checksum: " << sum
+              << std::endl;
+    return status;
+}
+
+template<size_t size, size_t tag>
+bool runPrefetch()
+{
+    using namespace L3::PrefetchPolicy;
+    bool status = true;
+    status &= run<size, None, tag>("None");
+    status &= run<size, Ahead<2>, tag + 1>("Ahead<2>");
+    status &= run<size, Ahead<8>, tag + 2>("Ahead<8>");
+    return status;
+}
+
+int
+main()
+{
+    bool status = true;
+
+    status &= runPrefetch<128, 1000>();
+    std::cerr << "runPrefetch<128>: " << status << std::endl;
+
+    status &= runPrefetch<256, 1010>();
+    std::cerr << "runPrefetch<256>: " << status << std::endl;
+
+    return status ? 0 : 1;
+}
@@ -0,0 +1,335 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <L3/static/available.h>
+#include <L3/static/disruptor.h>
+#include <L3/static/processor.h>
+#include <L3/static/selector.h>
+#include <L3/static/spinpolicy.h>
+#include <L3/util/scopedtimer.h>
+
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+//
+// Consumers run by EventProcessors and shut down by halting them
+// rather than by end of stream messages.
+//
+#ifndef L3_ITERATIONS
+#    define L3_ITERATIONS 10000000
+#endif 
+
+constexpr size_t iterations {L3_ITERATIONS};
+
+#ifndef L3_QSIZE
+#    define L3_QSIZE 17
+#endif
+
+using namespace std::chrono;
+using secs = duration<double>;
+using Msg = size_t;
+using Spin = L3::SpinPolicy::Yield;
+//
+// Checks messages arrive in order.
+//
+struct Check
+{
+    size_t& count;
+    bool& status;
+
+    void operator()(Msg m)
+    {
+        status &= m == ++count;
+    }
+};
+
+namespace testGroup
+{
+    //
+    // Two consumers of the producer then a bridge following both
+    // into a second disruptor with its own consumer.
+    //
+    //     P - D1 - C1
+    //          \ - C2 - C3 - D2 - C4
+    //
+    using D1 = L3::Disruptor<Msg, L3_QSIZE, L3::Tag<1900>>;
+    using Get1 = D1::Get<L3::Tag<1>>;
+    using Get2 = D1::Get<L3::Tag<2>>;
+    using Get3 = D1::Get<L3::Tag<3>, L3::Barrier<Get1, Get2>>;
+    using Put1 = D1::Put<L3::Barrier<Get3>, L3::CommitPolicy::Unique, Spin>;
+
+    using D2 = L3::Disruptor<Msg, L3_QSIZE, L3::Tag<1901>>;
+    using Get4 = D2::Get<>;
+    using Put2 = D2::Put<L3::Barrier<Get4>, L3::CommitPolicy::Unique, Spin>;
+
+    bool test()
+    {
+        size_t counts[4] = {};
+        bool status[4] = {true, true, true, true};
+
+        auto c1 = L3::makeProcessor<Get1>(Check{counts[0], status[0]});
+        auto c2 = L3::makeProcessor<Get2>(Check{counts[1], status[1]});
+        auto c3 = L3::makeProcessor<Get3>(
+            [&](Msg m)
+            {
+                Check{counts[2], status[2]}(m);
+                Put2() = m;
+            });
+        auto c4 = L3::makeProcessor<Get4>(Check{counts[3], status[3]});
+
+        L3::Group group;
+        group.add(*c1).add(*c2).add(*c3).add(*c4);
+
+        L3::ScopedTimer<>::duration elapsed{0};
+        {
+            L3::ScopedTimer<> timer(elapsed);
+            group.start();
+            for(Msg i = 1; i <= iterations; ++i)
+            {
+                Put1() = i;
+            }
+            group.halt();
+        }
+        std::cout << "group: throughput: "
+                  << (iterations / duration_cast<secs>(elapsed).count()) /
+            std::mega::num
+                  << " M msgs/s" << std::endl;
+
+        bool result = !c1->running() && !c4->running();
+        for(size_t i = 0; i < 4; ++i)
+        {
+            result &= status[i] && counts[i] == iterations;
+        }
+        return result;
+    }
+}
+
+namespace testSelector
+{
+    using D1 = L3::Disruptor<Msg, 10, L3::Tag<1910>>;
+    using D2 = L3::Disruptor<Msg, 10, L3::Tag<1911>>;
+    using Put1 = D1::Put<L3::Barrier<D1::Get<>>,
+                          L3::CommitPolicy::Unique,
+                          Spin>;
+    using Put2 = D2::Put<L3::Barrier<D2::Get<>>,
+                          L3::CommitPolicy::Unique,
+                          Spin>;
+
+    template<typename D>
+    struct Handler
+    {
+        static size_t count;
+        static bool status;
+
+        void operator()(Msg m) { status &= m == ++count; }
+    };
+
+    template<typename D> size_t Handler<D>::count{0};
+    template<typename D> bool Handler<D>::status{true};
+
+    using Selector = L3::Selector<D1::Get<>, Handler<D1>,
+                                  D2::Get<>, Handler<D2>>;
+
+    bool test()
+    {
+        constexpr size_t n = 100000;
+
+        L3::EventProcessor<L3::Source::Select<Selector>, Spin> selector;
+        selector.start();
+        std::thread p1([]{ for(Msg i = 1; i <= n; ++i) Put1() = i; });
+        std::thread p2([]{ for(Msg i = 1; i <= n; ++i) Put2() = i; });
+        p1.join();
+        p2.join();
+        selector.halt();
+
+        return Handler<D1>::status && Handler<D1>::count == n &&
+            Handler<D2>::status && Handler<D2>::count == n &&
+            Selector::select() == 0;
+    }
+}
+
+namespace testIdle
+{
+    using D = L3::Disruptor<Msg, 10, L3::Tag<1920>>;
+    using Get = D::Get<>;
+    using Put = D::Put<>;
+    //
+    // A processor parked on the futex of an idle ring halts
+    // promptly and starts again where it left off.
+    //
+    bool test()
+    {
+        size_t count = 0;
+        bool status = true;
+        using Park = L3::SpinPolicy::Block<10, 1000000>;
+        auto c = L3::makeProcessor<Get, Park>(Check{count, status});
+
+        bool result = true;
+        for(Msg i = 1; i <= 3; ++i)
+        {
+            c->start();
+            std::this_thread::sleep_for(milliseconds(10));
+            Put() = i;
+            std::this_thread::sleep_for(milliseconds(10));
+
+            auto start = steady_clock::now();
+            c->halt();
+            result &= steady_clock::now() - start < milliseconds(500);
+        }
+        return result && status && count == 3;
+    }
+}
+
+namespace testError
+{
+    using D = L3::Disruptor<Msg, 10, L3::Tag<1930>>;
+    using Get = D::Get<>;
+    using Put = D::Put<>;
+
+    bool test()
+    {
+        auto c = L3::makeProcessor<Get, Spin>(
+            [](Msg m)
+            {
+                if(m == 2)
+                {
+                    throw std::runtime_error("bad message");
+                }
+            });
+        c->start();
+        Put() = 1;
+        Put() = 2;
+        try
+        {
+            c->halt();
+        }
+        catch(const std::runtime_error&)
+        {
+            return !c->running();
+        }
+        return false;
+    }
+}
+
+namespace testPlacement
+{
+    using D = L3::Disruptor<Msg, 10, L3::Tag<1940>>;
+    using Get = D::Get<>;
+    using Put = D::Put<>;
+    //
+    // Pinning to cpu 0 should always work. SCHED_FIFO needs
+    // privileges we may not have but the thread must run either way.
+    //
+    bool test()
+    {
+        size_t count = 0;
+        bool status = true;
+        bool result = true;
+        {
+            auto c = L3::makeProcessor<Get, Spin>(Check{count, status},
+                                                  L3::ThreadOptions(0));
+            result &= c->start();
+            Put() = 1;
+            c->halt();
+        }
+        {
+            auto c = L3::makeProcessor<Get, Spin>(Check{count, status},
+                                                  L3::ThreadOptions(0, 1));
+            bool placed = c->start();
+            std::cout << "SCHED_FIFO: " << placed << std::endl;
+            Put() = 2;
+            c->halt();
+        }
+        return result && status && count == 2;
+    }
+}
+
+//
+// A processor behind an availability buffer with shared producers.
+// Parked on the buffer, it halts promptly.
+//
+namespace testAvailable
+{
+    using D = L3::Disruptor<Msg, 10, L3::Tag<1950>>;
+    using Get = D::Get<void, L3::Barrier<L3::AvailabilityBuffer<D>>>;
+    using Put = D::Put<L3::Barrier<Get>, L3::CommitPolicy::Available, Spin>;
+
+    bool test()
+    {
+        const Msg n = 10000;
+        Msg sum = 0;
+        size_t count = 0;
+        using Park = L3::SpinPolicy::Block<10, 1000000>;
+        auto c = L3::makeProcessor<Get, Park>(
+            [&](Msg m)
+            {
+                sum += m;
+                ++count;
+            });
+        c->start();
+        auto produce = [](Msg first)
+        {
+            for(Msg i = first; i <= n; i += 2)
+            {
+                Put() = i;
+            }
+        };
+        std::thread p1(produce, 1);
+        std::thread p2(produce, 2);
+        p1.join();
+        p2.join();
+        std::this_thread::sleep_for(milliseconds(10));
+
+        auto start = steady_clock::now();
+        c->halt();
+        return steady_clock::now() - start < milliseconds(500) &&
+            count == n && sum == n * (n + 1) / 2;
+    }
+}
+
+int
+main()
+{
+    bool status = true;
+
+    status &= testGroup::test();
+    std::cerr << "testGroup::test: " << status << std::endl;
+
+    status &= testSelector::test();
+    std::cerr << "testSelector::test: " << status << std::endl;
+
+    status &= testIdle::test();
+    std::cerr << "testIdle::test: " << status << std::endl;
+
+    status &= testError::test();
+    std::cerr << "testError::test: " << status << std::endl;
+
+    status &= testPlacement::test();
+    std::cerr << "testPlacement::test: " << status << std::endl;
+
+    status &= testAvailable::test();
+    std::cerr << "testAvailable::test: " << status << std::endl;
+
+    return status ? 0 : 1;
+}
@@ -0,0 +1,310 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <L3/static/disruptor.h>
+#include <L3/util/scopedtimer.h>
+
+#include <algorithm>
+#include <thread>
+#include <iostream>
+
+#ifndef L3_ITERATIONS
+#    define L3_ITERATIONS 10000000
+#endif 
+
+constexpr size_t iterations {L3_ITERATIONS};
+
+#ifndef L3_QSIZE
+#    define L3_QSIZE 20
+#endif
+
+using namespace std::chrono;
+using secs = duration<double>;
+//
+// Consume sequential integers checking nothing is lost or reordered.
+//
+template<typename D, typename Get>
+bool consume()
+{
+    typename D::Msg previous = 0;
+    for(typename D::Msg i = 1; i < iterations;)
+    {
+        for(auto msg: Get())
+        {
+            if(msg != previous + 1)
+            {
+                std::cout << "FAIL: previous: " << previous
+                          << ", msg: " << msg
+                          << std::endl;
+                return false;
+            }
+            previous = msg;
+            i++;
+        }
+    }
+    return true;
+}
+
+template<typename Producer, typename Consumer>
+bool time(const char* name, Producer producer, Consumer consumer)
+{
+    bool status;
+    L3::ScopedTimer<>::duration elapsed{0};
+    {
+        L3::ScopedTimer<> timer(elapsed);
+        std::thread prod(producer);
+        status = consumer();
+        prod.join();
+    }
+    std::cout << name << ": "
+              << (iterations / duration_cast<secs>(elapsed).count()) /
+                 std::mega::num
+              << " M msgs/s" << std::endl;
+    return status;
+}
+
+namespace testBatch1Thread
+{
+    using D = L3::Disruptor<size_t, 3, L3::Tag<600>>;
+    using Get = D::Get<>;
+    using Put = D::Put<>;
+
+    bool test()
+    {
+        {
+            Put::Batch b(3);
+            D::Msg m = 42;
+            for(auto& slot: b)
+            {
+                slot = m++;
+            }
+        }
+        Get g;
+        D::Iterator i = g.begin();
+        return *i++ == 42 && *i++ == 43 && *i++ == 44 && i == g.end();
+    }
+}
+
+namespace testBatch1to1
+{
+    using PutD = L3::Disruptor<size_t, L3_QSIZE, L3::Tag<610>>;
+    using BatchD = L3::Disruptor<size_t, L3_QSIZE, L3::Tag<620>>;
+
+    constexpr size_t batchSize = 64;
+
+    bool test()
+    {
+        bool result = time(
+            "Put",
+            []{ for(size_t i = 1; i < iterations; ++i) PutD::Put<>() = i; },
+            consume<PutD, PutD::Get<>>);
+
+        result &= time(
+            "Put::Batch",
+            []{
+                for(size_t i = 1; i < iterations;)
+                {
+                    BatchD::Put<>::Batch b(
+                        std::min(batchSize, iterations - i));
+                    for(auto& slot: b)
+                    {
+                        slot = i++;
+                    }
+                }
+            },
+            consume<BatchD, BatchD::Get<>>);
+        return result;
+    }
+}
+
+namespace testBatch2to1
+{
+    using D = L3::Disruptor<size_t, L3_QSIZE, L3::Tag<630>>;
+    using Get = D::Get<>;
+    using Put = D::Put<L3::Barrier<Get>, L3::CommitPolicy::Shared>;
+    //
+    // Each producer writes alternate numbers in batches of varying
+    // size. Batches are interleaved but within a batch order must be
+    // preserved.
+    //
+    void produce(D::Msg first)
+    {
+        size_t batchSize = 1;
+        for(D::Msg i = first; i < iterations;)
+        {
+            Put::Batch b(std::min(batchSize, (iterations - i + 1) / 2));
+            for(auto& slot: b)
+            {
+                slot = i;
+                i += 2;
+            }
+            batchSize = batchSize % 100 + 1;
+        }
+    }
+
+    bool test()
+    {
+        std::thread producer1([]{ produce(3); });
+        std::thread producer2([]{ produce(2); });
+
+        D::Msg oldOdd = 1;
+        D::Msg oldEven = 0;
+        bool result = true;
+        for(size_t i = 2; i < iterations;)
+        {
+            for(auto msg: Get())
+            {
+                ++i;
+                D::Msg& old = msg & 0x1L ? oldOdd : oldEven;
+                if(msg != old + 2)
+                {
+                    std::cout << "FAIL: old: " << old << ", new: " << msg
+                              << std::endl;
+                    result = false;
+                }
+                old = msg;
+            }
+        }
+        producer1.join();
+        producer2.join();
+        return result;
+    }
+}
+
+namespace testSpans
+{
+    using D = L3::Disruptor<size_t, 3, L3::Tag<640>, L3::LayoutPolicy::Packed>;
+    using Get = D::Get<>;
+    using Put = D::Put<>;
+
+    bool test()
+    {
+        const D::Msg msgs[] = { 1, 2, 3, 4, 5, 6 };
+        //
+        // Second batch wraps round the end of the ring.
+        //
+        Put::Batch(msgs, msgs + 5);
+        Get();
+        Put::Batch(msgs, msgs + 6);
+
+        Get g;
+        auto spans = L3::spans(g);
+        D::Msg copied[6];
+        D::Msg* out = copied;
+        for(auto& span: spans)
+        {
+            out = std::copy(span.begin(), span.end(), out);
+        }
+        return spans[0].size() == 3 && spans[1].size() == 3 &&
+            std::equal(msgs, msgs + 6, copied);
+    }
+}
+//
+// Bridge 64K message batches from one ring to another a message at a
+// time and as spans.
+//
+namespace testBridge
+{
+    using Packed = L3::LayoutPolicy::Packed;
+
+    template<size_t tag>
+    using D = L3::Disruptor<size_t, L3_QSIZE, L3::Tag<tag>, Packed>;
+
+    constexpr size_t batchSize = 64 * 1024;
+
+    template<typename In, typename Out>
+    void produce()
+    {
+        for(size_t i = 1; i < iterations;)
+        {
+            typename In::template Put<>::Batch b(
+                std::min(batchSize, iterations - i));
+            for(auto& slot: b)
+            {
+                slot = i++;
+            }
+        }
+    }
+
+    template<typename In, typename Out>
+    bool bridge(const char* name, bool bySpan)
+    {
+        return time(
+            name,
+            [=]{
+                std::thread producer(produce<In, Out>);
+                for(size_t i = 1; i < iterations;)
+                {
+                    typename In::template Get<> g(batchSize);
+                    i += L3::Index(g.end()) - L3::Index(g.begin());
+                    if(bySpan)
+                    {
+                        for(auto& span: L3::spans(g))
+                        {
+                            using Put = typename Out::template Put<>;
+                            typename Put::Batch(span.begin(), span.end());
+                        }
+                    }
+                    else
+                    {
+                        for(auto msg: g)
+                        {
+                            typename Out::template Put<>() = msg;
+                        }
+                    }
+                }
+                producer.join();
+            },
+            consume<Out, typename Out::template Get<>>);
+    }
+
+    bool test()
+    {
+        bool result = bridge<D<650>, D<660>>("bridge by message", false);
+        result &= bridge<D<670>, D<680>>("bridge by span", true);
+        return result;
+    }
+}
+
+int
+main()
+{
+    bool status = true;
+
+    status &= testBatch1Thread::test();
+    std::cerr << "testBatch1Thread::test: " << status << std::endl;
+
+    status &= testBatch1to1::test();
+    std::cerr << "testBatch1to1::test: " << status << std::endl;
+
+    status &= testBatch2to1::test();
+    std::cerr << "testBatch2to1::test: " << status << std::endl;
+
+    status &= testSpans::test();
+    std::cerr << "testSpans::test: " << status << std::endl;
+
+    status &= testBridge::test();
+    std::cerr << "testBridge::test: " << status << std::endl;
+
+    return status ? 0 : 1;
+}
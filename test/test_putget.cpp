@@ -23,8 +23,10 @@ SOFTWARE.
 */
 #include <L3/static/disruptor.h>
 
+#include <algorithm>
 #include <thread>
 #include <iostream>
+#include <string>
 
 #ifndef L3_ITERATIONS
 #    define L3_ITERATIONS 10000000
@@ -191,6 +193,185 @@ namespace testSpins1to1to1
     }
 }
 
+namespace testTryPut
+{
+    using D = L3::Disruptor<size_t, 1, L3::Tag<175>>;
+
+    using Get = D::Get<>;
+    using Put = D::Put<L3::Barrier<Get>, L3::CommitPolicy::Shared>;
+
+    bool test()
+    {
+        using Clock = std::chrono::steady_clock;
+
+        for(int i = 0; i < 2; ++i)
+        {
+            if(!Put(Put::noBlock))
+            {
+                return false;
+            }
+        }
+        //
+        // Ring is full. Failed claims must not use up a sequence.
+        //
+        L3::Index next = Put::cursor;
+        if(Put(Put::noBlock) ||
+           Put::tryClaim() ||
+           Put(Clock::now() + std::chrono::milliseconds(1)) ||
+           Put::cursor != next)
+        {
+            return false;
+        }
+        {
+            Get g(Clock::now() + std::chrono::milliseconds(1));
+            auto i = g.begin();
+            if(L3::Index(g.end()) - L3::Index(i) != 2)
+            {
+                return false;
+            }
+        }
+        {
+            Get g(Clock::now() + std::chrono::milliseconds(1));
+            if(g.begin() != g.end())
+            {
+                return false;
+            }
+        }
+        if(auto p = Put::tryClaim())
+        {
+            p = 42;
+        }
+        else
+        {
+            return false;
+        }
+        return *Get(Get::noBlock).begin() == 42;
+    }
+}
+
+namespace testEmplace
+{
+    using D = L3::Disruptor<std::string, 1, L3::Tag<180>>;
+
+    using Get = D::Get<>;
+    using Put = D::Put<>;
+
+    bool test()
+    {
+        //
+        // Moving a message in hands over its buffer.
+        //
+        std::string moved(100, 'a');
+        const char* buffer = moved.data();
+        Put() = std::move(moved);
+        Put().emplace(100, 'b');
+
+        const char* buffers[2];
+        {
+            Get g;
+            auto i = g.begin();
+            if(i->data() != buffer || *i++ != std::string(100, 'a') ||
+               *i++ != std::string(100, 'b'))
+            {
+                return false;
+            }
+            buffers[0] = g.begin()->data();
+            buffers[1] = (++g.begin())->data();
+        }
+        //
+        // Writing into the old message reuses its capacity.
+        //
+        for(auto b: buffers)
+        {
+            Put p;
+            p->assign(50, 'c');
+            if(p->data() != b)
+            {
+                return false;
+            }
+        }
+        for(auto& m: Get())
+        {
+            if(m != std::string(50, 'c'))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+namespace testRandomAccess
+{
+    using D = L3::Disruptor<size_t, 3, L3::Tag<185>>;
+
+    //
+    // Get sorts its batch in place so the prefetching consumer gates
+    // on it rather than reading the slots alongside it.
+    //
+    using Get = D::Get<>;
+    using PrefetchGet = D::Get<L3::Tag<1>,
+                               L3::Barrier<Get>,
+                               L3::NoOp,
+                               L3::PrefetchPolicy::Ahead<2>>;
+    using Put = D::Put<L3::Barrier<PrefetchGet>>;
+
+    template<typename G>
+    bool check(size_t first, size_t last)
+    {
+        for(auto m: G())
+        {
+            if(m != first++)
+            {
+                return false;
+            }
+        }
+        return first == last;
+    }
+
+    bool test()
+    {
+        //
+        // Go part way round the ring so the batch wraps.
+        //
+        for(size_t i = 0; i < 5; ++i)
+        {
+            Put() = i;
+        }
+        if(!check<Get>(0, 5) || !check<PrefetchGet>(0, 5))
+        {
+            return false;
+        }
+
+        const size_t values[] = {7, 3, 5, 1, 8, 2, 6, 4};
+        for(auto v: values)
+        {
+            Put() = v;
+        }
+        {
+            Get g;
+            auto b = g.begin();
+            auto e = g.end();
+            if(e - b != 8 || b[4] != 8 || *(b + 2) != 5 || *(e - 1) != 4 ||
+               !(b < e) || b + 8 != e || 8 + b != e)
+            {
+                return false;
+            }
+            std::sort(b, e);
+            if(!std::is_sorted(b, e) ||
+               std::lower_bound(b, e, 5) - b != 4 ||
+               std::binary_search(b, e, 9))
+            {
+                return false;
+            }
+        }
+        //
+        // Sorted in place so the prefetching consumer sees 1..8.
+        //
+        return check<PrefetchGet>(1, 9);
+    }
+}
+
 namespace test1to1
 {
     using D = L3::Disruptor<size_t, L3_QSIZE, L3::Tag<200>>;
@@ -479,6 +660,15 @@ main()
     // status &= testSpins1to1to1::test();
     // std::cerr << "testSpins1to1to1::test: " << status << std::endl;
 
+    status &= testTryPut::test();
+    std::cerr << "testTryPut::test: " << status << std::endl;
+
+    status &= testEmplace::test();
+    std::cerr << "testEmplace::test: " << status << std::endl;
+
+    status &= testRandomAccess::test();
+    std::cerr << "testRandomAccess::test: " << status << std::endl;
+
     status &= test1to1::test();
     std::cerr << "test1to1::test: " << status  << std::endl;
 
@@ -0,0 +1,191 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <L3/static/disruptor.h>
+#include <L3/static/reclaim.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef L3_ITERATIONS
+#    define L3_ITERATIONS 1000000
+#endif 
+
+constexpr size_t iterations {L3_ITERATIONS};
+
+#ifndef L3_QSIZE
+#    define L3_QSIZE 14
+#endif
+//
+// Large enough to defeat the small string optimisation.
+//
+constexpr size_t msgSize = 200;
+
+using namespace std::chrono;
+using Clock = steady_clock;
+using Msg = std::string;
+//
+// Producer put latencies.
+//
+std::vector<Clock::duration> latencies(iterations);
+
+void report(const char* name)
+{
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [](double p)
+    {
+        return duration_cast<nanoseconds>(
+            latencies[size_t(p * (iterations - 1))]).count();
+    };
+    std::cout << name
+              << ": p50: " << percentile(0.5) << "ns"
+              << ", p99: " << percentile(0.99) << "ns"
+              << ", p99.9: " << percentile(0.999) << "ns"
+              << std::endl;
+}
+
+template<typename D, typename Get>
+bool consume()
+{
+    for(size_t i = 0; i < iterations;)
+    {
+        for(const Msg& m: Get())
+        {
+            ++i;
+            if(m.size() != msgSize)
+            {
+                std::cout << "FAIL: size: " << m.size() << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+//
+// Run producer in this thread timing each put. F does the put.
+//
+template<typename D, typename Get, typename F>
+bool run(const char* name, F put)
+{
+    bool status;
+    std::thread consumer([&]{ status = consume<D, Get>(); });
+    for(auto& latency: latencies)
+    {
+        Clock::time_point start = Clock::now();
+        put();
+        latency = Clock::now() - start;
+    }
+    consumer.join();
+    report(name);
+    return status;
+}
+
+template<typename Reclaim>
+struct Reclaiming
+{
+    std::atomic<bool> running{true};
+    std::thread thread{[this]{ Reclaim::run(running); }};
+
+    ~Reclaiming()
+    {
+        running = false;
+        thread.join();
+    }
+};
+//
+// Producer frees the message it overwrites.
+//
+namespace testNoReclaim
+{
+    using D = L3::Disruptor<Msg, L3_QSIZE, L3::Tag<700>>;
+    using Get = D::Get<>;
+    using Put = D::Put<>;
+
+    bool test()
+    {
+        return run<D, Get>(
+            "no reclaimer", []{ Put() = Msg(msgSize, 'x'); });
+    }
+}
+//
+// Reclaimer frees messages. Producer only allocates.
+//
+namespace testReclaimDestroy
+{
+    using D = L3::Disruptor<Msg, L3_QSIZE, L3::Tag<710>>;
+    using Get = D::Get<>;
+    using Reclaim = L3::Reclaimer<D, L3::Barrier<Get>>;
+    using Put = D::Put<L3::Barrier<Reclaim::Get>>;
+
+    bool test()
+    {
+        Reclaiming<Reclaim> reclaiming;
+        return run<D, Get>(
+            "reclaimer destroy", []{ Put() = Msg(msgSize, 'x'); });
+    }
+}
+//
+// Reclaimer clears messages and producer reuses their memory. No
+// allocation once the ring has been round once.
+//
+namespace testReclaimClear
+{
+    using D = L3::Disruptor<Msg, L3_QSIZE, L3::Tag<720>>;
+    using Get = D::Get<>;
+    using Reclaim = L3::Reclaimer<D,
+                                  L3::Barrier<Get>,
+                                  L3::ReclaimPolicy::Clear>;
+    using Put = D::Put<L3::Barrier<Reclaim::Get>>;
+
+    bool test()
+    {
+        Reclaiming<Reclaim> reclaiming;
+        return run<D, Get>(
+            "reclaimer clear",
+            []{
+                Put p;
+                p->assign(msgSize, 'x');
+            });
+    }
+}
+
+int
+main()
+{
+    bool status = true;
+
+    status &= testNoReclaim::test();
+    std::cerr << "testNoReclaim::test: " << status << std::endl;
+
+    status &= testReclaimDestroy::test();
+    std::cerr << "testReclaimDestroy::test: " << status << std::endl;
+
+    status &= testReclaimClear::test();
+    std::cerr << "testReclaimClear::test: " << status << std::endl;
+
+    return status ? 0 : 1;
+}
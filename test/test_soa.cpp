@@ -0,0 +1,189 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+#include <L3/static/disruptor.h>
+#include <L3/util/scopedtimer.h>
+
+#include <iostream>
+#include <thread>
+#include <tuple>
+
+#ifndef L3_ITERATIONS
+#    define L3_ITERATIONS 10000000
+#endif 
+
+constexpr size_t iterations {L3_ITERATIONS};
+
+#ifndef L3_QSIZE
+#    define L3_QSIZE 17
+#endif
+
+using namespace std::chrono;
+using secs = duration<double>;
+//
+// Price, quantity, id and timestamp.
+//
+using Msg = std::tuple<double, size_t, size_t, size_t>;
+
+namespace testSoA1Thread
+{
+    using D = L3::Disruptor<Msg, 2, L3::Tag<900>, L3::LayoutPolicy::SoA>;
+    using Get = D::Get<>;
+    using Put = D::Put<>;
+
+    bool test()
+    {
+        //
+        // Move the cursors along so that the next batch wraps.
+        //
+        for(size_t i = 0; i < 3; ++i)
+        {
+            Put().emplace(0.0, 0, 0, 0);
+        }
+        Get();
+        for(size_t i = 1; i < 4; ++i)
+        {
+            Put p;
+            std::get<0>(*p) = i * 1.5;
+            std::get<1>(*p) = i;
+        }
+        Get g;
+        size_t qty = 0;
+        for(auto row: g)
+        {
+            if(std::get<0>(row) != std::get<1>(row) * 1.5)
+            {
+                return false;
+            }
+            qty += std::get<1>(row);
+        }
+        auto prices = L3::column<0>(g);
+        double total = 0;
+        for(auto& span: prices)
+        {
+            for(double price: span)
+            {
+                total += price;
+            }
+        }
+        return prices[0].size() == 1 && prices[1].size() == 2 &&
+            qty == 6 && total == 9.0;
+    }
+}
+//
+// Consumer totals the price field only. AoS reads whole messages, SoA
+// reads just the prices.
+//
+template<typename D, typename Total>
+bool run(const char* name, Total total)
+{
+    using Get = typename D::template Get<>;
+    using Put = typename D::template Put<>;
+
+    double sum = 0;
+    L3::ScopedTimer<>::duration elapsed{0};
+    {
+        L3::ScopedTimer<> timer(elapsed);
+        std::thread producer(
+            []{
+                for(size_t i = 0; i < iterations; ++i)
+                {
+                    Put() = Msg(1.0, i, i, i);
+                }
+            });
+        for(size_t i = 0; i < iterations;)
+        {
+            Get g;
+            i += L3::Index(g.end()) - L3::Index(g.begin());
+            sum += total(g);
+        }
+        producer.join();
+    }
+    std::cout << name << ": "
+              << (iterations / duration_cast<secs>(elapsed).count()) /
+                 std::mega::num
+              << " M msgs/s" << std::endl;
+    return sum == iterations;
+}
+
+namespace testAoS
+{
+    using D = L3::Disruptor<Msg, L3_QSIZE, L3::Tag<910>,
+                            L3::LayoutPolicy::Packed>;
+
+    bool test()
+    {
+        return run<D>(
+            "AoS",
+            [](const D::Get<>& g)
+            {
+                double total = 0;
+                for(auto& m: g)
+                {
+                    total += std::get<0>(m);
+                }
+                return total;
+            });
+    }
+}
+
+namespace testSoA
+{
+    using D = L3::Disruptor<Msg, L3_QSIZE, L3::Tag<920>,
+                            L3::LayoutPolicy::SoA>;
+
+    bool test()
+    {
+        return run<D>(
+            "SoA",
+            [](const D::Get<>& g)
+            {
+                double total = 0;
+                for(auto& span: L3::column<0>(g))
+                {
+                    for(double price: span)
+                    {
+                        total += price;
+                    }
+                }
+                return total;
+            });
+    }
+}
+
+int
+main()
+{
+    bool status = true;
+
+    status &= testSoA1Thread::test();
+    std::cerr << "testSoA1Thread::test: " << status << std::endl;
+
+    status &= testAoS::test();
+    std::cerr << "testAoS::test: " << status << std::endl;
+
+    status &= testSoA::test();
+    std::cerr << "testSoA::test: " << status << std::endl;
+
+    return status ? 0 : 1;
+}
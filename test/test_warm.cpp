@@ -0,0 +1,166 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <L3/non_static/disruptor.h>
+#include <L3/static/disruptor.h>
+#include <L3/static/warm.h>
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+//
+// Put latency on the first lap round a large ring, cold and after
+// warming. There's no consumer. A lap is one less than the ring size
+// so the producer never has to wait.
+//
+#ifndef L3_QSIZE
+#    define L3_QSIZE 19
+#endif
+
+using namespace std::chrono;
+using Clock = steady_clock;
+using Msg = size_t;
+
+constexpr size_t lap = (size_t(1) << L3_QSIZE) - 1;
+
+std::vector<Clock::duration> latencies(lap);
+
+inline long minorFaults()
+{
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_minflt;
+}
+
+//
+// Put a lap of messages and report latency. Returns how many page
+// faults that took.
+//
+template<typename F>
+long run(const char* name, F put)
+{
+    long faults = minorFaults();
+    for(auto& latency: latencies)
+    {
+        Clock::time_point start = Clock::now();
+        put();
+        latency = Clock::now() - start;
+    }
+    faults = minorFaults() - faults;
+
+    Clock::duration total{0};
+    for(auto l: latencies)
+    {
+        total += l;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [](double p)
+    {
+        return duration_cast<nanoseconds>(
+            latencies[size_t(p * (lap - 1))]).count();
+    };
+    std::cout << name
+              << ": faults: " << faults
+              << ", total: " << duration_cast<microseconds>(total).count()
+              << "us, p50: " << percentile(0.5) << "ns"
+              << ", p99.9: " << percentile(0.999) << "ns"
+              << ", p99.99: " << percentile(0.9999) << "ns"
+              << ", max: " << percentile(1) << "ns"
+              << std::endl;
+    return faults;
+}
+
+template<size_t tag>
+struct Static
+{
+    using D = L3::Disruptor<Msg, L3_QSIZE, L3::Tag<tag>>;
+    using Put = typename D::template Put<>;
+
+    static void put() { Put() = 1; }
+};
+
+namespace testStatic
+{
+    bool test()
+    {
+        using Cold = Static<1700>;
+        using Warm = Static<1710>;
+
+        long cold = run("static cold", Cold::put);
+        bool locked = L3::warm<Warm::D>();
+        std::cout << "static warm: locked: " << locked << std::endl;
+        long warm = run("static warm", Warm::put);
+        return warm < cold;
+    }
+}
+
+namespace testRuntime
+{
+    namespace NS = L3::NonStatic;
+
+    long runtime(const char* name, unsigned options)
+    {
+        NS::Disruptor<Msg> d(L3_QSIZE, 1, L3::Memory::anonymous, options);
+        NS::Consumer<Msg> consumer(d, NS::Barrier(d));
+        NS::Producer<Msg> producer(d, NS::Barrier(consumer));
+        if(options & L3::Memory::lock)
+        {
+            std::cout << name << ": locked: " << d.memory().locked()
+                      << std::endl;
+        }
+        return run(name, [&]{ NS::Producer<Msg>::Put{producer} = 1; });
+    }
+
+    bool test()
+    {
+        using L3::Memory;
+        //
+        // The cold ring must be left untouched when it's made for
+        // this to compare anything.
+        //
+        long cold = runtime("runtime cold", Memory::none);
+        long warm = runtime("runtime warm",
+                            Memory::hugePages |
+                            Memory::prefault |
+                            Memory::lock);
+        return warm < cold;
+    }
+}
+
+int
+main()
+{
+    bool status = true;
+
+    status &= testStatic::test();
+    std::cerr << "testStatic::test: " << status << std::endl;
+
+    status &= testRuntime::test();
+    std::cerr << "testRuntime::test: " << status << std::endl;
+
+    return status ? 0 : 1;
+}
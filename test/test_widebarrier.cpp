@@ -0,0 +1,161 @@
+/*
+The MIT License (MIT)
+
+Copyright (c) 2015 Norman Wilson - Volcano Consultancy Ltd
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+#include <L3/static/barrier.h>
+#include <L3/util/cacheline.h>
+#include <L3/util/scopedtimer.h>
+#include <L3/util/types.h>
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+//
+// Cost of Barrier::least() as a chain of std::min against
+// WideBarrier's balanced tree of mins for 2 to 64 cursors. First
+// with the cursors left alone, so every load hits in cache and the
+// chain is usually as quick, then with another thread moving them
+// as consumers would, which is the case WideBarrier is for.
+//
+#ifndef L3_ITERATIONS
+#    define L3_ITERATIONS 10000000
+#endif 
+
+constexpr size_t iterations {L3_ITERATIONS};
+
+using namespace std::chrono;
+//
+// Stand in for a consumer. Each cursor is on its own cache line.
+//
+template<size_t i, bool contended = false>
+struct Cursor
+{
+    L3_CACHE_LINE static L3::Sequence cursor;
+};
+
+template<size_t i, bool contended>
+L3_CACHE_LINE L3::Sequence
+Cursor<i, contended>::cursor{1000 + (i * 7919) % 61};
+
+template<typename Barrier>
+double time(L3::Index& result)
+{
+    L3::ScopedTimer<>::duration elapsed{0};
+    {
+        L3::ScopedTimer<> timer(elapsed);
+        for(size_t i = 0; i < iterations; ++i)
+        {
+            result += Barrier::least();
+        }
+    }
+    return double(duration_cast<nanoseconds>(elapsed).count()) / iterations;
+}
+
+template<size_t... i>
+bool run(L3::Indices<i...>)
+{
+    L3::Index chain = 0;
+    L3::Index wide = 0;
+    double chainTime = time<L3::Barrier<Cursor<i>...>>(chain);
+    double wideTime = time<L3::WideBarrier<Cursor<i>...>>(wide);
+    std::cout << sizeof...(i) << " cursors: Barrier: " << chainTime
+              << "ns, WideBarrier: " << wideTime << "ns" << std::endl;
+    return chain == wide && chain == iterations * 1000;
+}
+
+template<size_t n>
+bool run()
+{
+    return run(typename L3::MakeIndices<n>::type());
+}
+//
+// Move each cursor on in turn until stopped. Only this thread
+// stores to them so a load and store will do. Sequence only lets
+// Gets and Puts store; a C style cast reaches its atomic base
+// regardless.
+//
+using Atomic = std::atomic<L3::Index>;
+
+template<size_t... i>
+void advance(const std::atomic<bool>& stop)
+{
+    Atomic* moved[] = { (Atomic*)&Cursor<i, true>::cursor... };
+    while(!stop.load(std::memory_order_relaxed))
+    {
+        for(auto m: moved)
+        {
+            m->store(m->load(std::memory_order_relaxed) + 1,
+                     std::memory_order_release);
+        }
+    }
+}
+
+template<size_t... i>
+bool contended(L3::Indices<i...>)
+{
+    std::atomic<bool> stop{false};
+    std::thread mover(advance<i...>, std::cref(stop));
+    L3::Index chain = 0;
+    L3::Index wide = 0;
+    double chainTime = time<L3::Barrier<Cursor<i, true>...>>(chain);
+    double wideTime = time<L3::WideBarrier<Cursor<i, true>...>>(wide);
+    stop = true;
+    mover.join();
+    std::cout << sizeof...(i) << " contended cursors: Barrier: "
+              << chainTime << "ns, WideBarrier: " << wideTime << "ns"
+              << std::endl;
+    //
+    // Cursors only move forward.
+    //
+    return chain >= iterations * 1000 && wide >= chain;
+}
+
+template<size_t n>
+bool contended()
+{
+    return contended(typename L3::MakeIndices<n>::type());
+}
+
+int
+main()
+{
+    bool status = true;
+
+    status &= run<2>();
+    status &= run<3>();
+    status &= run<4>();
+    status &= run<8>();
+    status &= run<16>();
+    status &= run<32>();
+    status &= run<64>();
+    std::cerr << "run: " << status << std::endl;
+
+    status &= contended<2>();
+    status &= contended<4>();
+    status &= contended<8>();
+    status &= contended<16>();
+    status &= contended<64>();
+    std::cerr << "contended: " << status << std::endl;
+
+    return status ? 0 : 1;
+}